@@ -3,16 +3,38 @@
 #include "Log.h"
 
 #include "Xero/Platform/Vulkan/VulkanSwapchain.h"
+#include "Xero/Renderer/Renderer.h"
 
 #include "imgui.h"
 
-#include <glfw/glfw3.h>
-
 namespace Xero {
 
 	#define BIND_EVENT_FN(fn) std::bind(&Application::##fn, this, std::placeholders::_1)
 
 	Application* Application::s_Instance = nullptr;
+	WindowProps Application::s_WindowProps;
+
+	void Application::SetCommandLineArgs(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string_view arg = argv[i];
+			size_t split = arg.find('=');
+			std::string_view name = arg.substr(0, split);
+			std::string_view value = split != std::string_view::npos ? arg.substr(split + 1) : std::string_view();
+
+			if (name == "--headless")
+				s_WindowProps.Headless = true;
+			else if (name == "--frames")
+				s_WindowProps.HeadlessFrameCount = (uint32_t)std::strtoul(std::string(value).c_str(), nullptr, 10);
+			else if (name == "--capture")
+				s_WindowProps.CapturePath = value;
+			else if (name == "--width")
+				s_WindowProps.Width = (uint32_t)std::strtoul(std::string(value).c_str(), nullptr, 10);
+			else if (name == "--height")
+				s_WindowProps.Height = (uint32_t)std::strtoul(std::string(value).c_str(), nullptr, 10);
+		}
+	}
 
 	Application::Application()
 	{
@@ -21,16 +43,18 @@ namespace Xero {
 		Log::Init();
 		XO_CORE_INFO("Log Initialized");
 
-		m_Window = Window::Create();
+		m_Window = Window::Create(s_WindowProps);
 		m_Window->SetEventCallback(BIND_EVENT_FN(OnEvent));
 
+		Renderer::Init();
+
 		m_ImGuiLayer = ImGuiLayer::Create();
 		PushOverlay(m_ImGuiLayer);
 	}
 
 	Application::~Application()
 	{
-
+		Renderer::Shutdown();
 	}
 
 	void Application::Run()
@@ -41,6 +65,10 @@ namespace Xero {
 			{
 				m_Window->ProcessEvent();
 
+				// Acquire first, everything recorded below targets the acquired image
+				m_Window->GetSwapchain().BeginFrame();
+				Renderer::BeginFrame();
+
 				for (Layer* layer : m_LayerStack)
 					layer->OnUpdate(m_TimeStep);
 
@@ -49,8 +77,14 @@ namespace Xero {
 					layer->OnImGuiRender();
 				m_ImGuiLayer->End();
 
-				m_Window->GetSwapchain().BeginFrame();
 				m_Window->SwapBuffers();
+				Renderer::EndFrame();
+
+				if (!m_FirstFramePresented)
+				{
+					XO_CORE_INFO("Time to first frame: {0}ms", m_StartupTimer.ElapsedMillis());
+					m_FirstFramePresented = true;
+				}
 			}
 
 			float time = GetTime();
@@ -87,7 +121,8 @@ namespace Xero {
 
 	float Application::GetTime() const
 	{
-		return (float)glfwGetTime(); // TODO: Should be in PLATFORM
+		// Not glfwGetTime, a headless window never initializes GLFW
+		return m_StartupTimer.Elapsed();
 	}
 
 	bool Application::OnWindowClose(WindowCloseEvent& e)
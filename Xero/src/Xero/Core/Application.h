@@ -3,6 +3,7 @@
 #include "Xero/Core/Core.h"
 #include "Xero/Core/Window.h"
 #include "Xero/Core/LayerStack.h"
+#include "Xero/Core/Timer.h"
 
 #include "Xero/Events/Event.h"
 #include "Xero/Events/ApplicationEvent.h"
@@ -29,6 +30,10 @@ namespace Xero {
 	public:
 		inline static Application& Get() { return *s_Instance; }
 
+		// Called before the application is created. Understands --headless, --frames=<count>, --capture=<path>,
+		// --width=<pixels> and --height=<pixels>
+		static void SetCommandLineArgs(int argc, char** argv);
+
 	private:
 		bool OnWindowClose(WindowCloseEvent& e);
 
@@ -41,8 +46,12 @@ namespace Xero {
 		bool m_Running = true, m_Minimized = false;
 		float m_LastFrameTime = 0.0f;
 
+		Timer m_StartupTimer;
+		bool m_FirstFramePresented = false;
+
 	private:
 		static Application* s_Instance;
+		static WindowProps s_WindowProps;
 	};
 
 	// To be defined in CLIENT
@@ -6,6 +6,8 @@ extern Xero::Application* Xero::CreateApplication();
 
 int main(int argc, char** argv)
 {
+	Xero::Application::SetCommandLineArgs(argc, argv);
+
 	auto app = Xero::CreateApplication();
 	app->Run();
 	delete app;
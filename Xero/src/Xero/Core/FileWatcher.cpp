@@ -0,0 +1,149 @@
+#include "xopch.h"
+#include "FileWatcher.h"
+
+#if defined(__linux__)
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace Xero {
+
+#if !defined(__linux__)
+	// Timestamp polling touches the file system, so it is throttled instead of running every frame
+	static constexpr float s_PollInterval = 0.5f;
+#endif
+
+	FileWatcher::FileWatcher()
+	{
+#if defined(__linux__)
+		m_Handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_Handle < 0)
+			XO_CORE_ERROR("FileWatcher: inotify_init1 failed ({0})", errno);
+#endif
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+#if defined(__linux__)
+		if (m_Handle >= 0)
+			close(m_Handle);
+#endif
+	}
+
+	std::filesystem::path FileWatcher::Normalize(const std::filesystem::path& path)
+	{
+		std::error_code error;
+		std::filesystem::path absolutePath = std::filesystem::absolute(path, error);
+		return (error ? path : absolutePath).lexically_normal();
+	}
+
+	void FileWatcher::Watch(const std::filesystem::path& path)
+	{
+		std::filesystem::path normalized = Normalize(path);
+		std::string key = normalized.string();
+		if (m_Files.find(key) != m_Files.end())
+			return;
+
+		m_Files[key] = normalized;
+
+#if defined(__linux__)
+		if (m_Handle < 0)
+			return;
+
+		// Editors commonly save through a rename, so watch the directory rather than the file itself
+		std::filesystem::path directory = normalized.parent_path();
+		if (m_DirectoryWatches.find(directory.string()) != m_DirectoryWatches.end())
+			return;
+
+		int watch = inotify_add_watch(m_Handle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (watch < 0)
+		{
+			XO_CORE_ERROR("FileWatcher: could not watch {0} ({1})", directory.string(), errno);
+			return;
+		}
+
+		m_Directories[watch] = directory;
+		m_DirectoryWatches[directory.string()] = watch;
+#else
+		std::error_code error;
+		m_WriteTimes[key] = std::filesystem::last_write_time(normalized, error);
+#endif
+	}
+
+	void FileWatcher::Unwatch(const std::filesystem::path& path)
+	{
+		std::filesystem::path normalized = Normalize(path);
+		if (!m_Files.erase(normalized.string()))
+			return;
+
+#if defined(__linux__)
+		std::filesystem::path directory = normalized.parent_path();
+		for (const auto& [key, file] : m_Files)
+		{
+			if (file.parent_path() == directory)
+				return;
+		}
+
+		auto it = m_DirectoryWatches.find(directory.string());
+		if (it == m_DirectoryWatches.end())
+			return;
+
+		inotify_rm_watch(m_Handle, it->second);
+		m_Directories.erase(it->second);
+		m_DirectoryWatches.erase(it);
+#else
+		m_WriteTimes.erase(normalized.string());
+#endif
+	}
+
+	std::vector<std::filesystem::path> FileWatcher::Poll()
+	{
+		std::vector<std::filesystem::path> result;
+		std::unordered_set<std::string> changed;
+
+#if defined(__linux__)
+		if (m_Handle < 0)
+			return result;
+
+		alignas(inotify_event) char buffer[4096];
+		while (true)
+		{
+			ssize_t length = read(m_Handle, buffer, sizeof(buffer));
+			if (length <= 0)
+				break;
+
+			for (char* ptr = buffer; ptr < buffer + length; )
+			{
+				const inotify_event* event = (const inotify_event*)ptr;
+				ptr += sizeof(inotify_event) + event->len;
+
+				auto directory = m_Directories.find(event->wd);
+				if (directory == m_Directories.end() || event->len == 0)
+					continue;
+
+				std::string key = (directory->second / event->name).string();
+				if (m_Files.find(key) != m_Files.end() && changed.insert(key).second)
+					result.push_back(m_Files.at(key));
+			}
+		}
+#else
+		if (m_PollTimer.Elapsed() < s_PollInterval)
+			return result;
+		m_PollTimer.Reset();
+
+		for (auto& [key, writeTime] : m_WriteTimes)
+		{
+			std::error_code error;
+			auto currentWriteTime = std::filesystem::last_write_time(m_Files.at(key), error);
+			if (error || currentWriteTime == writeTime)
+				continue;
+
+			writeTime = currentWriteTime;
+			result.push_back(m_Files.at(key));
+		}
+#endif
+
+		return result;
+	}
+
+}
\ No newline at end of file
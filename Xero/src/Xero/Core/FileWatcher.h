@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Xero/Core/Timer.h"
+
+#include <filesystem>
+
+namespace Xero {
+
+	// Watches individual files for modification. Polling is non-blocking, so it is
+	// safe to call once per frame. Uses inotify on Linux and timestamp polling elsewhere
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		void Watch(const std::filesystem::path& path);
+		void Unwatch(const std::filesystem::path& path);
+
+		// Returns the watched files that changed since the last call
+		std::vector<std::filesystem::path> Poll();
+
+		static std::filesystem::path Normalize(const std::filesystem::path& path);
+
+	private:
+		std::unordered_map<std::string, std::filesystem::path> m_Files; // normalized path -> path
+#if defined(__linux__)
+		int m_Handle = -1;
+		std::unordered_map<int, std::filesystem::path> m_Directories; // watch descriptor -> directory
+		std::unordered_map<std::string, int> m_DirectoryWatches; // directory -> watch descriptor
+#else
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+		Timer m_PollTimer;
+#endif
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "xopch.h"
+#include "ThreadPool.h"
+
+namespace Xero {
+
+	static thread_local bool s_IsWorkerThread = false;
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+		{
+			// Leave one core for the main thread
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		m_Workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+
+		XO_CORE_TRACE("ThreadPool: started {0} worker threads", threadCount);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::scoped_lock<std::mutex> lock(m_QueueMutex);
+			m_Running = false;
+		}
+		m_Condition.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		s_IsWorkerThread = true;
+
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_QueueMutex);
+				m_Condition.wait(lock, [this]() { return !m_Running || !m_Jobs.empty(); });
+
+				// Drain the queue before exiting so no submitted future is left without a value
+				if (!m_Running && m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop();
+			}
+
+			job();
+		}
+	}
+
+	ThreadPool& ThreadPool::Get()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	bool ThreadPool::IsWorkerThread()
+	{
+		return s_IsWorkerThread;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+
+namespace Xero {
+
+	class ThreadPool
+	{
+	public:
+		ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		template<typename Func>
+		auto Submit(Func&& func) -> std::future<std::invoke_result_t<Func>>
+		{
+			using ReturnType = std::invoke_result_t<Func>;
+
+			auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(func));
+			std::future<ReturnType> result = task->get_future();
+
+			// Jobs submitted from a worker run inline, a worker blocking on its own queue would deadlock the pool
+			if (m_Workers.empty() || IsWorkerThread())
+			{
+				(*task)();
+				return result;
+			}
+
+			{
+				std::scoped_lock<std::mutex> lock(m_QueueMutex);
+				m_Jobs.emplace([task]() { (*task)(); });
+			}
+			m_Condition.notify_one();
+
+			return result;
+		}
+
+		uint32_t GetThreadCount() const { return (uint32_t)m_Workers.size(); }
+
+	public:
+		static ThreadPool& Get();
+		static bool IsWorkerThread();
+
+	private:
+		void WorkerLoop();
+
+	private:
+		std::vector<std::thread> m_Workers;
+		std::queue<std::function<void()>> m_Jobs;
+
+		std::mutex m_QueueMutex;
+		std::condition_variable m_Condition;
+		bool m_Running = true;
+	};
+
+}
\ No newline at end of file
@@ -17,6 +17,11 @@ namespace Xero {
 		uint32_t Height;
 		bool VSync;
 
+		// No OS window, surface or swapchain, frames are rendered into offscreen images (CI, benchmarks, image tests)
+		bool Headless = false;
+		uint32_t HeadlessFrameCount = 0; // Closes the window after this many frames, 0 runs until closed
+		std::string CapturePath; // Headless only, the last frame is written here, .png or raw RGBA8
+
 		WindowProps(const std::string& title = "Xero Engine", uint32_t width = 1280, uint32_t height = 720)
 			:Title(title), Width(width), Height(height), VSync(true) {}
 	};
@@ -0,0 +1,85 @@
+#include "xopch.h"
+#include "HeadlessWindow.h"
+
+#include "Xero/Events/ApplicationEvent.h"
+
+#include "Xero/Renderer/Renderer.h"
+#include "Xero/Renderer/RendererContext.h"
+#include "Xero/Platform/Vulkan/VulkanContext.h"
+
+namespace Xero {
+
+	HeadlessWindow::HeadlessWindow(const WindowProps& props)
+	{
+		Init(props);
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		Shutdown();
+	}
+
+	void HeadlessWindow::Init(const WindowProps& props)
+	{
+		m_Data.Title = props.Title;
+		m_Data.Width = props.Width;
+		m_Data.Height = props.Height;
+		m_Data.VSync = false;
+		m_Data.FrameCount = props.HeadlessFrameCount;
+		m_Data.CapturePath = props.CapturePath;
+
+		XO_CORE_INFO("Creating headless window: \"{0}\" ({1}, {2})", props.Title, props.Width, props.Height);
+
+		// Has to be set before the context is created, it decides the instance and device extensions
+		Renderer::GetConfig().Headless = true;
+
+		m_RendererContext = RendererContext::Create();
+		m_RendererContext->Init();
+
+		Ref<VulkanContext> context = m_RendererContext.As<VulkanContext>();
+		m_Swapchain.InitHeadless(context->GetDevice());
+
+		m_Swapchain.Create(&m_Data.Width, &m_Data.Height);
+
+		m_FrameTimer.Reset();
+	}
+
+	void HeadlessWindow::Shutdown()
+	{
+		if (m_FrameStats.Frames > 0)
+		{
+			XO_CORE_INFO("Headless frame times over {0} frames: avg {1:.3f}ms, min {2:.3f}ms, max {3:.3f}ms",
+				m_FrameStats.Frames, m_FrameStats.TotalMillis / m_FrameStats.Frames, m_FrameStats.MinMillis, m_FrameStats.MaxMillis);
+		}
+
+		// The context is released after this and reports whatever is still allocated
+		m_Swapchain.Cleanup();
+		m_RendererContext->Shutdown();
+	}
+
+	void HeadlessWindow::SwapBuffers()
+	{
+		m_Swapchain.Present();
+
+		m_RendererContext.As<VulkanContext>()->SavePipelineCacheIfNeeded();
+
+		float frameTime = m_FrameTimer.ElapsedMillis();
+		m_FrameTimer.Reset();
+
+		m_FrameStats.Frames++;
+		m_FrameStats.TotalMillis += frameTime;
+		m_FrameStats.MinMillis = std::min(m_FrameStats.MinMillis, frameTime);
+		m_FrameStats.MaxMillis = std::max(m_FrameStats.MaxMillis, frameTime);
+
+		if (m_Data.FrameCount == 0 || m_FrameStats.Frames < m_Data.FrameCount)
+			return;
+
+		if (!m_Data.CapturePath.empty())
+			m_Swapchain.Capture(m_Data.CapturePath);
+
+		// The application finishes the current frame and leaves the run loop
+		WindowCloseEvent event;
+		m_Data.EventCallback(event);
+	}
+
+}
\ No newline at end of file
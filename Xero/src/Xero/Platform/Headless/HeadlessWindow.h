@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Xero/Core/Window.h"
+#include "Xero/Core/Timer.h"
+#include "Xero/Platform/Vulkan/VulkanSwapchain.h"
+
+#include <cfloat>
+
+namespace Xero {
+
+	// Window without an OS window or surface. Renders into offscreen images cycled like a swapchain, so the engine
+	// runs on machines without a display or presentation support (CI, software rasterizers)
+	class HeadlessWindow : public Window
+	{
+	public:
+		HeadlessWindow(const WindowProps& props);
+		virtual ~HeadlessWindow();
+
+		virtual void ProcessEvent() override {}
+		virtual void SwapBuffers() override;
+
+		inline uint32_t GetWidth() const override { return m_Data.Width; }
+		inline uint32_t GetHeight() const override { return m_Data.Height; }
+
+		inline void SetEventCallback(const EventCallbackFn& callback) override { m_Data.EventCallback = callback; }
+		// Frames are never paced to a display
+		virtual void SetVSync(bool enabled) override { m_Data.VSync = enabled; }
+		virtual bool IsVSync() const override { return m_Data.VSync; }
+
+		inline virtual void* GetNativeWindow() const override { return nullptr; }
+		virtual Ref<RendererContext> GetRendererContext() override { return m_RendererContext; }
+		virtual VulkanSwapchain& GetSwapchain() override { return m_Swapchain; }
+
+	private:
+		void Init(const WindowProps& props);
+		void Shutdown();
+
+	private:
+		struct WindowData
+		{
+			std::string Title;
+			uint32_t Width, Height;
+			bool VSync;
+
+			uint32_t FrameCount = 0; // 0 runs until the application closes
+			std::string CapturePath;
+
+			EventCallbackFn EventCallback;
+		};
+
+		WindowData m_Data;
+
+		// Frame times measured between SwapBuffers calls, logged on shutdown
+		struct FrameStats
+		{
+			uint32_t Frames = 0;
+			float TotalMillis = 0.0f;
+			float MinMillis = FLT_MAX;
+			float MaxMillis = 0.0f;
+		};
+
+		FrameStats m_FrameStats;
+		Timer m_FrameTimer;
+
+		Ref<RendererContext> m_RendererContext;
+		VulkanSwapchain m_Swapchain;
+	};
+
+}
\ No newline at end of file
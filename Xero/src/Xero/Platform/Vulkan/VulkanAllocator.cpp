@@ -2,6 +2,7 @@
 #include "VulkanAllocator.h"
 
 #include "VulkanContext.h"
+#include "VulkanRenderer.h"
 
 #include "Xero/Utils/StringUtils.h"
 
@@ -11,14 +12,76 @@ namespace Xero {
 	// Helpers
 	//////////////////////////////////////////////////////////////////////////
 
+	struct VulkanAllocationRecord
+	{
+		std::string Tag;
+		uint64_t Size = 0;
+		uint32_t HeapIndex = 0;
+	};
+
+	struct VulkanMemoryPool
+	{
+		VmaPool Pool = nullptr;
+		VulkanMemoryPoolSpecification Specification;
+	};
+
 	struct VulkanAllocatorData
 	{
 		VmaAllocator Allocator;
-		uint64_t TotalAllocatedBytes = 0;
+		std::unordered_map<std::string, VulkanMemoryPool> Pools;
+
+		// Allocations come from loading threads as well as the render thread
+		std::unordered_map<VmaAllocation, VulkanAllocationRecord> Allocations;
+		std::map<std::string, GPUMemoryCounters> TagStats;
+		std::vector<GPUMemoryCounters> HeapStats;
+		GPUMemoryCounters TotalStats;
+		std::mutex Mutex;
 	};
 
 	static VulkanAllocatorData* s_Data = nullptr;
 
+	static void AddToCounters(GPUMemoryCounters& counters, uint64_t size)
+	{
+		counters.AllocatedBytes += size;
+		counters.AllocationCount++;
+		counters.PeakBytes = std::max(counters.PeakBytes, counters.AllocatedBytes);
+	}
+
+	static void RemoveFromCounters(GPUMemoryCounters& counters, uint64_t size)
+	{
+		counters.AllocatedBytes -= size;
+		counters.AllocationCount--;
+	}
+
+	static void TrackAllocation(const std::string& tag, VmaAllocation allocation)
+	{
+		VmaAllocationInfo allocInfo{};
+		vmaGetAllocationInfo(s_Data->Allocator, allocation, &allocInfo);
+
+		const auto& memoryProps = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetMemoryProperties();
+		uint32_t heapIndex = memoryProps.memoryTypes[allocInfo.memoryType].heapIndex;
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		s_Data->Allocations[allocation] = { tag, allocInfo.size, heapIndex };
+		AddToCounters(s_Data->TagStats[tag], allocInfo.size);
+		AddToCounters(s_Data->HeapStats[heapIndex], allocInfo.size);
+		AddToCounters(s_Data->TotalStats, allocInfo.size);
+	}
+
+	static void UntrackAllocation(VmaAllocation allocation)
+	{
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		auto it = s_Data->Allocations.find(allocation);
+		XO_CORE_ASSERT(it != s_Data->Allocations.end(), "Freeing an allocation VulkanAllocator does not know about");
+
+		const VulkanAllocationRecord& record = it->second;
+		RemoveFromCounters(s_Data->TagStats[record.Tag], record.Size);
+		RemoveFromCounters(s_Data->HeapStats[record.HeapIndex], record.Size);
+		RemoveFromCounters(s_Data->TotalStats, record.Size);
+		s_Data->Allocations.erase(it);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Vulkan Memory Allocator
 	//////////////////////////////////////////////////////////////////////////
@@ -38,19 +101,47 @@ namespace Xero {
 	{
 		VmaAllocationCreateInfo allocCreateInfo = {};
 		allocCreateInfo.usage = usage;
+		return CreateBuffer(bufferCreateInfo, allocCreateInfo, outBuffer);
+	}
 
-		VmaAllocation allocation;
-		vmaCreateBuffer(s_Data->Allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, nullptr);
+	VmaAllocation VulkanAllocator::AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, const std::string& poolName, VkBuffer& outBuffer)
+	{
+		VulkanMemoryPool pool;
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+			auto it = s_Data->Pools.find(poolName);
+			XO_CORE_ASSERT(it != s_Data->Pools.end(), "Unknown memory pool");
+			pool = it->second;
+		}
+		XO_CORE_ASSERT((bufferCreateInfo.usage & pool.Specification.BufferUsage) == bufferCreateInfo.usage, "Buffer usage is not covered by the pool");
 
-		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_Data->Allocator, allocation, &allocInfo);
-		XO_CORE_TRACE("Vulkan Allocator ({0}): allocating buffer; size = {1}", m_Tag, Utils::BytesToString(allocInfo.size));
+		// VMA keeps the pool within its block limit, a full pool falls through to a regular allocation below
+		VmaAllocationCreateInfo allocCreateInfo = {};
+		allocCreateInfo.pool = pool.Pool;
 
+		VmaAllocation allocation;
+		VkResult result = vmaCreateBuffer(s_Data->Allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, nullptr);
+		if (result == VK_SUCCESS)
 		{
-			s_Data->TotalAllocatedBytes += allocInfo.size;
-			XO_CORE_TRACE("Vulkan Allocator ({0}): total allocated since start is = {1}", m_Tag, Utils::BytesToString(s_Data->TotalAllocatedBytes));
+			TrackAllocation(m_Tag, allocation);
+			return allocation;
 		}
 
+		XO_CORE_TRACE("VulkanAllocator ({0}): pool '{1}' cannot fit {2}, allocating outside of it", m_Tag, poolName, Utils::BytesToString(bufferCreateInfo.size));
+		allocCreateInfo = {};
+		allocCreateInfo.usage = pool.Specification.Usage;
+		return CreateBuffer(bufferCreateInfo, allocCreateInfo, outBuffer);
+	}
+
+	VmaAllocation VulkanAllocator::CreateBuffer(const VkBufferCreateInfo& bufferCreateInfo, const VmaAllocationCreateInfo& allocCreateInfo, VkBuffer& outBuffer)
+	{
+		VmaAllocation allocation;
+		VK_CHECK_RESULT(vmaCreateBuffer(s_Data->Allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, nullptr));
+
+		TrackAllocation(m_Tag, allocation);
+		XO_CORE_TRACE("VulkanAllocator ({0}): allocating buffer; size = {1}", m_Tag, Utils::BytesToString(bufferCreateInfo.size));
+		XO_CORE_TRACE("VulkanAllocator ({0}): total live allocations = {1}", m_Tag, Utils::BytesToString(GetTotalStats().AllocatedBytes));
+
 		return allocation;
 	}
 
@@ -60,35 +151,49 @@ namespace Xero {
 		allocCreateInfo.usage = usage;
 
 		VmaAllocation allocation;
-		vmaCreateImage(s_Data->Allocator, &imageCreateInfo, &allocCreateInfo, &outImage, &allocation, nullptr);
+		VK_CHECK_RESULT(vmaCreateImage(s_Data->Allocator, &imageCreateInfo, &allocCreateInfo, &outImage, &allocation, nullptr));
 
-		VmaAllocationInfo allocInfo;
-		vmaGetAllocationInfo(s_Data->Allocator, allocation, &allocInfo);
-		XO_CORE_TRACE("VulkanAllocator ({0}): allocating image; size = {1}", m_Tag, Utils::BytesToString(allocInfo.size));
+		TrackAllocation(m_Tag, allocation);
+		XO_CORE_TRACE("VulkanAllocator ({0}): allocating image; {1}x{2}", m_Tag, imageCreateInfo.extent.width, imageCreateInfo.extent.height);
+		XO_CORE_TRACE("VulkanAllocator ({0}): total live allocations = {1}", m_Tag, Utils::BytesToString(GetTotalStats().AllocatedBytes));
 
-		{
-			s_Data->TotalAllocatedBytes += allocInfo.size;
-			XO_CORE_TRACE("VulkanAllocator ({0}): total allocated since start is {1}", m_Tag, Utils::BytesToString(s_Data->TotalAllocatedBytes));
-		}
 		return allocation;
 	}
 
 	void VulkanAllocator::Free(VmaAllocation allocation)
 	{
-		vmaFreeMemory(s_Data->Allocator, allocation);
+		VulkanRenderer::SubmitResourceFree([allocator = *this, allocation]() mutable { allocator.FreeImmediate(allocation); });
 	}
 
 	void VulkanAllocator::DestroyImage(VkImage image, VmaAllocation allocation)
 	{
 		XO_CORE_ASSERT(image);
 		XO_CORE_ASSERT(allocation);
-		vmaDestroyImage(s_Data->Allocator, image, allocation);
+		VulkanRenderer::SubmitResourceFree([allocator = *this, image, allocation]() mutable { allocator.DestroyImageImmediate(image, allocation); });
 	}
 
 	void VulkanAllocator::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation)
 	{
 		XO_CORE_ASSERT(buffer);
 		XO_CORE_ASSERT(allocation);
+		VulkanRenderer::SubmitResourceFree([allocator = *this, buffer, allocation]() mutable { allocator.DestroyBufferImmediate(buffer, allocation); });
+	}
+
+	void VulkanAllocator::FreeImmediate(VmaAllocation allocation)
+	{
+		UntrackAllocation(allocation);
+		vmaFreeMemory(s_Data->Allocator, allocation);
+	}
+
+	void VulkanAllocator::DestroyImageImmediate(VkImage image, VmaAllocation allocation)
+	{
+		UntrackAllocation(allocation);
+		vmaDestroyImage(s_Data->Allocator, image, allocation);
+	}
+
+	void VulkanAllocator::DestroyBufferImmediate(VkBuffer buffer, VmaAllocation allocation)
+	{
+		UntrackAllocation(allocation);
 		vmaDestroyBuffer(s_Data->Allocator, buffer, allocation);
 	}
 
@@ -110,6 +215,25 @@ namespace Xero {
 			XO_CORE_WARN("VmaBudget.usage = {0}", Utils::BytesToString(b.usage));
 		}
 		XO_CORE_WARN("-----------------------------------");
+		for (const auto& heap : GetHeapStats())
+		{
+			XO_CORE_WARN("Heap {0}{1}: {2} in {3} allocations, peak {4}", heap.HeapIndex, heap.DeviceLocal ? " (device local)" : "",
+				Utils::BytesToString(heap.Counters.AllocatedBytes), heap.Counters.AllocationCount, Utils::BytesToString(heap.Counters.PeakBytes));
+		}
+		for (const auto& [tag, counters] : GetTagStats())
+		{
+			XO_CORE_WARN("Tag '{0}': {1} in {2} allocations, peak {3}", tag,
+				Utils::BytesToString(counters.AllocatedBytes), counters.AllocationCount, Utils::BytesToString(counters.PeakBytes));
+		}
+		for (const auto& [name, pool] : s_Data->Pools)
+		{
+			VmaStatistics poolStats = GetPoolStats(name);
+			XO_CORE_WARN("Pool '{0}': {1} allocations, {2} used of {3} in {4} blocks", name, poolStats.allocationCount,
+				Utils::BytesToString(poolStats.allocationBytes), Utils::BytesToString(poolStats.blockBytes), poolStats.blockCount);
+		}
+		GPUMemoryCounters total = GetTotalStats();
+		XO_CORE_WARN("Total: {0} in {1} allocations, peak {2}", Utils::BytesToString(total.AllocatedBytes), total.AllocationCount, Utils::BytesToString(total.PeakBytes));
+		XO_CORE_WARN("-----------------------------------");
 	}
 
 	GPUMemoryStats VulkanAllocator::GetStats()
@@ -130,6 +254,106 @@ namespace Xero {
 		return { usage, budget };
 	}
 
+	GPUMemoryCounters VulkanAllocator::GetTotalStats()
+	{
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		return s_Data->TotalStats;
+	}
+
+	std::map<std::string, GPUMemoryCounters> VulkanAllocator::GetTagStats()
+	{
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		return s_Data->TagStats;
+	}
+
+	std::vector<GPUMemoryHeapStats> VulkanAllocator::GetHeapStats()
+	{
+		const auto& memoryProps = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetMemoryProperties();
+		std::vector<VmaBudget> budgets(memoryProps.memoryHeapCount);
+		vmaGetHeapBudgets(s_Data->Allocator, budgets.data());
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		std::vector<GPUMemoryHeapStats> heapStats(memoryProps.memoryHeapCount);
+		for (uint32_t i = 0; i < memoryProps.memoryHeapCount; i++)
+		{
+			GPUMemoryHeapStats& heap = heapStats[i];
+			heap.HeapIndex = i;
+			heap.DeviceLocal = memoryProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+			heap.Counters = s_Data->HeapStats[i];
+			heap.Usage = budgets[i].usage;
+			heap.Budget = budgets[i].budget;
+		}
+		return heapStats;
+	}
+
+	uint32_t VulkanAllocator::ReportLiveAllocations()
+	{
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+
+		if (s_Data->Allocations.empty())
+			return 0;
+
+		XO_CORE_ERROR("VulkanAllocator: {0} allocations ({1}) are still live", s_Data->Allocations.size(), Utils::BytesToString(s_Data->TotalStats.AllocatedBytes));
+		for (const auto& [allocation, record] : s_Data->Allocations)
+			XO_CORE_ERROR("  '{0}': {1} on heap {2}", record.Tag, Utils::BytesToString(record.Size), record.HeapIndex);
+
+		return (uint32_t)s_Data->Allocations.size();
+	}
+
+	void VulkanAllocator::CreatePool(const VulkanMemoryPoolSpecification& specification)
+	{
+		XO_CORE_ASSERT(specification.Algorithm != VulkanMemoryPoolAlgorithm::Ring || specification.MaxBlockCount <= 1, "A ring only wraps within one block");
+
+		// VMA creates a throwaway buffer from this to pick the memory type
+		VkBufferCreateInfo sampleBufferInfo{};
+		sampleBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		sampleBufferInfo.size = 1024;
+		sampleBufferInfo.usage = specification.BufferUsage;
+		sampleBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo sampleAllocInfo{};
+		sampleAllocInfo.usage = specification.Usage;
+
+		VmaPoolCreateInfo poolCreateInfo{};
+		VK_CHECK_RESULT(vmaFindMemoryTypeIndexForBufferInfo(s_Data->Allocator, &sampleBufferInfo, &sampleAllocInfo, &poolCreateInfo.memoryTypeIndex));
+		poolCreateInfo.blockSize = specification.BlockSize;
+		poolCreateInfo.minBlockCount = specification.MinBlockCount;
+		poolCreateInfo.maxBlockCount = specification.MaxBlockCount;
+		if (specification.Algorithm == VulkanMemoryPoolAlgorithm::Linear)
+		{
+			poolCreateInfo.flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+		}
+		else if (specification.Algorithm == VulkanMemoryPoolAlgorithm::Ring)
+		{
+			poolCreateInfo.flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+			poolCreateInfo.maxBlockCount = 1;
+		}
+
+		VulkanMemoryPool pool;
+		pool.Specification = specification;
+		pool.Specification.MaxBlockCount = poolCreateInfo.maxBlockCount;
+		VK_CHECK_RESULT(vmaCreatePool(s_Data->Allocator, &poolCreateInfo, &pool.Pool));
+		vmaSetPoolName(s_Data->Allocator, pool.Pool, specification.Name.c_str());
+
+		std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+		XO_CORE_ASSERT(s_Data->Pools.find(specification.Name) == s_Data->Pools.end(), "Memory pool names must be unique");
+		s_Data->Pools[specification.Name] = pool;
+	}
+
+	VmaStatistics VulkanAllocator::GetPoolStats(const std::string& poolName)
+	{
+		VmaPool pool;
+		{
+			std::scoped_lock<std::mutex> lock(s_Data->Mutex);
+			pool = s_Data->Pools.at(poolName).Pool;
+		}
+
+		VmaStatistics stats{};
+		vmaGetPoolStatistics(s_Data->Allocator, pool, &stats);
+		return stats;
+	}
+
 	void VulkanAllocator::Init(Ref<VulkanDevice> device)
 	{
 		s_Data = new VulkanAllocatorData();
@@ -142,11 +366,49 @@ namespace Xero {
 		allocatorInfo.instance = VulkanContext::GetInstance();
 
 		vmaCreateAllocator(&allocatorInfo, &s_Data->Allocator);
+
+		s_Data->HeapStats.resize(device->GetPhysicalDevice()->GetMemoryProperties().memoryHeapCount);
+
+		// Upload staging, retired batch by batch in submission order
+		VulkanMemoryPoolSpecification stagingPool;
+		stagingPool.Name = "Staging";
+		stagingPool.Algorithm = VulkanMemoryPoolAlgorithm::Ring;
+		stagingPool.Usage = VMA_MEMORY_USAGE_CPU_ONLY;
+		stagingPool.BufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		stagingPool.BlockSize = 64 * 1024 * 1024;
+		CreatePool(stagingPool);
+
+		// Per-frame data written by the CPU and read once by the GPU
+		VulkanMemoryPoolSpecification transientPool;
+		transientPool.Name = "Transient";
+		transientPool.Algorithm = VulkanMemoryPoolAlgorithm::Linear;
+		transientPool.Usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+		transientPool.BufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			| VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		transientPool.BlockSize = 32 * 1024 * 1024;
+		transientPool.MaxBlockCount = 2;
+		CreatePool(transientPool);
+
+		// Small long-lived GPU buffers as offsets into a few blocks, only used when asked for by name
+		VulkanMemoryPoolSpecification smallBufferPool;
+		smallBufferPool.Name = "SmallBuffers";
+		smallBufferPool.Algorithm = VulkanMemoryPoolAlgorithm::General;
+		smallBufferPool.Usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		smallBufferPool.BufferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+			| VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		smallBufferPool.BlockSize = 16 * 1024 * 1024;
+		CreatePool(smallBufferPool);
 	}
 
 	void VulkanAllocator::Shutdown()
 	{
-		vmaDestroyAllocator(s_Data->Allocator);
+		// VMA asserts on live allocations, leave the allocator to the process once they are reported
+		if (ReportLiveAllocations() == 0)
+		{
+			for (auto& [name, pool] : s_Data->Pools)
+				vmaDestroyPool(s_Data->Allocator, pool.Pool);
+			vmaDestroyAllocator(s_Data->Allocator);
+		}
 
 		delete s_Data;
 		s_Data = nullptr;
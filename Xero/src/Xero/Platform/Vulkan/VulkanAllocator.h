@@ -4,6 +4,8 @@
 #include "VulkanDevice.h"
 #include "vma/vk_mem_alloc.h"
 
+#include <map>
+
 namespace Xero {
 
 	struct GPUMemoryStats
@@ -12,6 +14,43 @@ namespace Xero {
 		uint64_t Free = 0;
 	};
 
+	// Live counters of what went through VulkanAllocator, PeakBytes is the high-water mark since Init
+	struct GPUMemoryCounters
+	{
+		uint64_t AllocatedBytes = 0;
+		uint32_t AllocationCount = 0;
+		uint64_t PeakBytes = 0;
+	};
+
+	struct GPUMemoryHeapStats
+	{
+		uint32_t HeapIndex = 0;
+		bool DeviceLocal = false;
+		GPUMemoryCounters Counters;
+		// Driver view from VMA, includes memory not allocated through us
+		uint64_t Usage = 0;
+		uint64_t Budget = 0;
+	};
+
+	enum class VulkanMemoryPoolAlgorithm
+	{
+		General = 0, // VMA's default algorithm, long-lived allocations of mixed sizes
+		Linear,      // Bump allocation, freed all at once or from either end
+		Ring         // Linear in a single block, freed in allocation order
+	};
+
+	struct VulkanMemoryPoolSpecification
+	{
+		std::string Name;
+		VulkanMemoryPoolAlgorithm Algorithm = VulkanMemoryPoolAlgorithm::General;
+		VmaMemoryUsage Usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		// Picks the memory type, buffers allocated from the pool should not need more than this
+		VkBufferUsageFlags BufferUsage = 0;
+		VkDeviceSize BlockSize = 0; // 0 leaves it to VMA
+		uint32_t MinBlockCount = 0;
+		uint32_t MaxBlockCount = 0; // 0 is unlimited
+	};
+
 	class VulkanAllocator
 	{
 	public:
@@ -20,12 +59,22 @@ namespace Xero {
 		~VulkanAllocator();
 
 		VmaAllocation AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, VmaMemoryUsage usage, VkBuffer& outBuffer);
+		// Suballocates from a named pool, falls back to a regular allocation with the pool's usage when the pool is full.
+		// Built in: "Staging" (ring, upload staging), "Transient" (linear, per-frame uniform and vertex data),
+		// "SmallBuffers" (general, small long-lived GPU buffers). Plain usage-based allocations never end up in a pool
+		VmaAllocation AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, const std::string& poolName, VkBuffer& outBuffer);
 		VmaAllocation AllocateImage(VkImageCreateInfo imageCreateInfo, VmaMemoryUsage usage, VkImage& outImage);
 
+		// Released once every frame that may still use them has completed on the GPU
 		void Free(VmaAllocation allocation);
 		void DestroyImage(VkImage image, VmaAllocation allocation);
 		void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
 
+		// Only for resources the GPU has provably finished with
+		void FreeImmediate(VmaAllocation allocation);
+		void DestroyImageImmediate(VkImage image, VmaAllocation allocation);
+		void DestroyBufferImmediate(VkBuffer buffer, VmaAllocation allocation);
+
 		template<typename T>
 		T* MapMemory(VmaAllocation allocation)
 		{
@@ -40,11 +89,24 @@ namespace Xero {
 		static void DumpStats();
 		static GPUMemoryStats GetStats();
 
+		static GPUMemoryCounters GetTotalStats();
+		static std::map<std::string, GPUMemoryCounters> GetTagStats();
+		static std::vector<GPUMemoryHeapStats> GetHeapStats();
+
+		static void CreatePool(const VulkanMemoryPoolSpecification& specification);
+		static VmaStatistics GetPoolStats(const std::string& poolName);
+
+		// Logs every allocation that has not been freed yet together with its tag, returns how many there are
+		static uint32_t ReportLiveAllocations();
+
 		static void Init(Ref<VulkanDevice> device);
 		static void Shutdown();
 
 		static VmaAllocator& GetVMAAllocator();
 
+	private:
+		VmaAllocation CreateBuffer(const VkBufferCreateInfo& bufferCreateInfo, const VmaAllocationCreateInfo& allocCreateInfo, VkBuffer& outBuffer);
+
 	private:
 		std::string m_Tag;
 	};
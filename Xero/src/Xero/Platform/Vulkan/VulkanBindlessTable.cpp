@@ -0,0 +1,245 @@
+#include "xopch.h"
+#include "VulkanBindlessTable.h"
+
+#include "VulkanContext.h"
+#include "VulkanRenderer.h"
+
+namespace Xero {
+
+	namespace Utils {
+
+		static VkDescriptorType BindlessBindingType(uint32_t binding)
+		{
+			switch (binding)
+			{
+			case VulkanBindlessTable::TextureBinding:		return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			case VulkanBindlessTable::StorageBufferBinding:	return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			case VulkanBindlessTable::StorageImageBinding:	return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			}
+			XO_CORE_ASSERT(false);
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		}
+
+	}
+
+	VulkanBindlessTable::VulkanBindlessTable(uint32_t maxTextures, uint32_t maxStorageBuffers, uint32_t maxStorageImages)
+	{
+		auto device = VulkanContext::GetCurrentDevice();
+		VkDevice vulkanDevice = device->GetVulkanDevice();
+		XO_CORE_ASSERT(device->IsDescriptorIndexingEnabled(), "The bindless table needs descriptor indexing");
+
+		VkPhysicalDeviceVulkan12Properties properties12{};
+		properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &properties12;
+		vkGetPhysicalDeviceProperties2(device->GetPhysicalDevice()->GetVulkanPhysicalDevice(), &properties);
+
+		// Combined image samplers count against both the sampler and the sampled image limits. The whole table is visible
+		// to every stage, so it also has to fit the per-stage budget shared by all three bindings
+		uint32_t textureLimit = std::min({ properties12.maxDescriptorSetUpdateAfterBindSamplers, properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+			properties12.maxPerStageDescriptorUpdateAfterBindSamplers, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages });
+		uint32_t storageBufferLimit = std::min(properties12.maxDescriptorSetUpdateAfterBindStorageBuffers, properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+		uint32_t storageImageLimit = std::min(properties12.maxDescriptorSetUpdateAfterBindStorageImages, properties12.maxPerStageDescriptorUpdateAfterBindStorageImages);
+
+		m_Slots[TextureBinding].Capacity = std::min(maxTextures, textureLimit);
+		m_Slots[StorageBufferBinding].Capacity = std::min(maxStorageBuffers, storageBufferLimit);
+		m_Slots[StorageImageBinding].Capacity = std::min(maxStorageImages, storageImageLimit);
+
+		uint32_t totalCount = m_Slots[TextureBinding].Capacity + m_Slots[StorageBufferBinding].Capacity + m_Slots[StorageImageBinding].Capacity;
+		if (totalCount > properties12.maxPerStageUpdateAfterBindResources)
+		{
+			float scale = (float)properties12.maxPerStageUpdateAfterBindResources / (float)totalCount;
+			for (auto& slots : m_Slots)
+				slots.Capacity = (uint32_t)(slots.Capacity * scale);
+		}
+
+		//////////////////////////////////////////////////////////////////////
+		// Descriptor Set Layout
+		//////////////////////////////////////////////////////////////////////
+
+		VkDescriptorSetLayoutBinding layoutBindings[3]{};
+		VkDescriptorBindingFlags bindingFlags[3]{};
+		for (uint32_t binding = 0; binding < 3; binding++)
+		{
+			layoutBindings[binding].binding = binding;
+			layoutBindings[binding].descriptorType = Utils::BindlessBindingType(binding);
+			layoutBindings[binding].descriptorCount = m_Slots[binding].Capacity;
+			layoutBindings[binding].stageFlags = VK_SHADER_STAGE_ALL;
+
+			// Unused slots may hold nothing or a released resource, shaders only ever read the indices they are given.
+			// Slots no frame in flight reads can be written while those frames execute
+			bindingFlags[binding] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+				| VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = 3;
+		bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = 3;
+		layoutInfo.pBindings = layoutBindings;
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(vulkanDevice, &layoutInfo, nullptr, &m_DescriptorSetLayout));
+
+		//////////////////////////////////////////////////////////////////////
+		// Descriptor Pool
+		//////////////////////////////////////////////////////////////////////
+
+		VkDescriptorPoolSize poolSizes[3];
+		for (uint32_t binding = 0; binding < 3; binding++)
+			poolSizes[binding] = { Utils::BindlessBindingType(binding), std::max(m_Slots[binding].Capacity, 1u) };
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = 3;
+		poolInfo.pPoolSizes = poolSizes;
+		VK_CHECK_RESULT(vkCreateDescriptorPool(vulkanDevice, &poolInfo, nullptr, &m_DescriptorPool));
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_DescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(vulkanDevice, &allocInfo, &m_DescriptorSet));
+
+		XO_CORE_INFO("VulkanBindlessTable: {0} textures, {1} storage buffers, {2} storage images",
+			m_Slots[TextureBinding].Capacity, m_Slots[StorageBufferBinding].Capacity, m_Slots[StorageImageBinding].Capacity);
+	}
+
+	VulkanBindlessTable::~VulkanBindlessTable()
+	{
+		// Owned by the renderer, which waits for the device before tearing down
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+	}
+
+	uint32_t VulkanBindlessTable::RegisterTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+	{
+		uint32_t index = AcquireSlot(TextureBinding);
+		if (index != InvalidIndex)
+			UpdateTexture(index, imageView, sampler, imageLayout);
+		return index;
+	}
+
+	uint32_t VulkanBindlessTable::RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		uint32_t index = AcquireSlot(StorageBufferBinding);
+		if (index != InvalidIndex)
+			UpdateStorageBuffer(index, buffer, offset, range);
+		return index;
+	}
+
+	uint32_t VulkanBindlessTable::RegisterStorageImage(VkImageView imageView)
+	{
+		uint32_t index = AcquireSlot(StorageImageBinding);
+		if (index != InvalidIndex)
+			UpdateStorageImage(index, imageView);
+		return index;
+	}
+
+	void VulkanBindlessTable::UpdateTexture(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+	{
+		VkDescriptorImageInfo imageInfo{ sampler, imageView, imageLayout };
+		Write(TextureBinding, index, &imageInfo, nullptr);
+	}
+
+	void VulkanBindlessTable::UpdateStorageBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+		Write(StorageBufferBinding, index, nullptr, &bufferInfo);
+	}
+
+	void VulkanBindlessTable::UpdateStorageImage(uint32_t index, VkImageView imageView)
+	{
+		VkDescriptorImageInfo imageInfo{ VK_NULL_HANDLE, imageView, VK_IMAGE_LAYOUT_GENERAL };
+		Write(StorageImageBinding, index, &imageInfo, nullptr);
+	}
+
+	void VulkanBindlessTable::ReleaseTexture(uint32_t index)
+	{
+		ReleaseSlot(TextureBinding, index);
+	}
+
+	void VulkanBindlessTable::ReleaseStorageBuffer(uint32_t index)
+	{
+		ReleaseSlot(StorageBufferBinding, index);
+	}
+
+	void VulkanBindlessTable::ReleaseStorageImage(uint32_t index)
+	{
+		ReleaseSlot(StorageImageBinding, index);
+	}
+
+	void VulkanBindlessTable::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const
+	{
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, DescriptorSetIndex, 1, &m_DescriptorSet, 0, nullptr);
+	}
+
+	uint32_t VulkanBindlessTable::AcquireSlot(uint32_t binding)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		SlotAllocator& slots = m_Slots[binding];
+		uint32_t index = InvalidIndex;
+		if (!slots.FreeSlots.empty())
+		{
+			index = slots.FreeSlots.back();
+			slots.FreeSlots.pop_back();
+		}
+		else if (slots.Next < slots.Capacity)
+		{
+			index = slots.Next++;
+		}
+		else
+		{
+			XO_CORE_ERROR("VulkanBindlessTable: binding {0} is full ({1} slots)", binding, slots.Capacity);
+			return InvalidIndex;
+		}
+
+		slots.Used++;
+		return index;
+	}
+
+	void VulkanBindlessTable::ReleaseSlot(uint32_t binding, uint32_t index)
+	{
+		if (index == InvalidIndex)
+			return;
+
+		// Draws in flight may still index the slot, it is handed out again once they have completed
+		VulkanRenderer::SubmitResourceFree([this, binding, index]()
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			m_Slots[binding].FreeSlots.push_back(index);
+			m_Slots[binding].Used--;
+		});
+	}
+
+	void VulkanBindlessTable::Write(uint32_t binding, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+	{
+		XO_CORE_ASSERT(index < m_Slots[binding].Capacity);
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = m_DescriptorSet;
+		write.dstBinding = binding;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = Utils::BindlessBindingType(binding);
+		write.pImageInfo = imageInfo;
+		write.pBufferInfo = bufferInfo;
+
+		// Update-after-bind lets the set change while bound in command buffers being recorded or executed,
+		// but updates to the set itself still have to be serialized
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		vkUpdateDescriptorSets(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), 1, &write, 0, nullptr);
+	}
+
+}
\ No newline at end of file
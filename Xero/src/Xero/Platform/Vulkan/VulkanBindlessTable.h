@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Vulkan.h"
+
+#include <mutex>
+
+namespace Xero {
+
+	// One global, partially bound, update-after-bind descriptor set holding every texture, storage buffer and storage image
+	// registered with it. Shaders declare it as set DescriptorSetIndex and take the indices through push constants:
+	//
+	//   layout(set = 3, binding = 0) uniform sampler2D u_Textures[];
+	//   layout(set = 3, binding = 1) buffer Buffers { ... } u_Buffers[];
+	//   layout(set = 3, binding = 2, rgba8) uniform image2D u_Images[];
+	//
+	// The set is bound once per command buffer, so draws only push their indices. Released indices are recycled once
+	// every frame that may still read them has completed
+	class VulkanBindlessTable
+	{
+	public:
+		static constexpr uint32_t DescriptorSetIndex = 3;
+		static constexpr uint32_t TextureBinding = 0;
+		static constexpr uint32_t StorageBufferBinding = 1;
+		static constexpr uint32_t StorageImageBinding = 2;
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	public:
+		// Capacities are clamped to the device's update-after-bind limits
+		VulkanBindlessTable(uint32_t maxTextures = 16384, uint32_t maxStorageBuffers = 4096, uint32_t maxStorageImages = 1024);
+		~VulkanBindlessTable();
+
+		// Safe from any thread. The descriptor is written immediately, it may be used by draws recorded afterwards
+		uint32_t RegisterTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t RegisterStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		uint32_t RegisterStorageImage(VkImageView imageView);
+
+		// Rewrites a slot in place, e.g. after the resource was recreated. No frame in flight may read the slot,
+		// otherwise release it and register the new resource
+		void UpdateTexture(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		void UpdateStorageBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		void UpdateStorageImage(uint32_t index, VkImageView imageView);
+
+		void ReleaseTexture(uint32_t index);
+		void ReleaseStorageBuffer(uint32_t index);
+		void ReleaseStorageImage(uint32_t index);
+
+		void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const;
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_DescriptorSetLayout; }
+		VkDescriptorSet GetDescriptorSet() const { return m_DescriptorSet; }
+
+		uint32_t GetTextureCount() const { return m_Slots[TextureBinding].Used; }
+		uint32_t GetStorageBufferCount() const { return m_Slots[StorageBufferBinding].Used; }
+		uint32_t GetStorageImageCount() const { return m_Slots[StorageImageBinding].Used; }
+
+	private:
+		struct SlotAllocator
+		{
+			uint32_t Capacity = 0;
+			uint32_t Next = 0; // Slots below this have been handed out at least once
+			uint32_t Used = 0;
+			std::vector<uint32_t> FreeSlots;
+		};
+
+		uint32_t AcquireSlot(uint32_t binding);
+		void ReleaseSlot(uint32_t binding, uint32_t index);
+		void Write(uint32_t binding, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo);
+
+	private:
+		VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+		SlotAllocator m_Slots[3];
+		std::mutex m_Mutex;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "xopch.h"
+#include "VulkanComputePipeline.h"
+
+#include "VulkanRenderer.h"
+
+namespace Xero {
+
+	VulkanComputePipeline::VulkanComputePipeline(const Ref<VulkanShader>& computeShader, const std::string& debugName)
+		: m_Shader(computeShader), m_DebugName(debugName)
+	{
+		XO_CORE_ASSERT(computeShader);
+		Invalidate();
+	}
+
+	void VulkanComputePipeline::Invalidate()
+	{
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		for (const auto& range : m_Shader->GetPushConstantRanges())
+			pushConstantRanges.push_back({ (VkShaderStageFlags)range.ShaderStage, range.Offset, range.Size });
+
+		VulkanPipelineStateCache& cache = VulkanRenderer::GetPipelineStateCache();
+		m_PipelineLayout = cache.GetOrCreatePipelineLayout(m_Shader->GetAllDescriptorSetLayouts(), pushConstantRanges);
+		m_Pipeline = cache.GetOrCreateComputePipeline(m_Shader, m_PipelineLayout, m_DebugName);
+		m_ShaderContentHash = m_Shader->GetContentHash();
+	}
+
+	void VulkanComputePipeline::Bind(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, GetVulkanPipeline());
+	}
+
+	void VulkanComputePipeline::BindDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t set)
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, GetVulkanPipelineLayout(), set, 1, &descriptorSet, 0, nullptr);
+	}
+
+	void VulkanComputePipeline::SetPushConstants(VkCommandBuffer commandBuffer, const void* data, uint32_t size, uint32_t offset)
+	{
+		vkCmdPushConstants(commandBuffer, GetVulkanPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
+	}
+
+	void VulkanComputePipeline::Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+	{
+		vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+	}
+
+	VkPipeline VulkanComputePipeline::GetVulkanPipeline()
+	{
+		if (m_ShaderContentHash != m_Shader->GetContentHash())
+			Invalidate();
+
+		return m_Pipeline;
+	}
+
+	VkPipelineLayout VulkanComputePipeline::GetVulkanPipelineLayout()
+	{
+		if (m_ShaderContentHash != m_Shader->GetContentHash())
+			Invalidate();
+
+		return m_PipelineLayout;
+	}
+
+}
\ No newline at end of file
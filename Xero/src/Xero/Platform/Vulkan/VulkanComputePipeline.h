@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanShader.h"
+
+namespace Xero {
+
+	// Compute counterpart of VulkanPipeline, resolved through the same pipeline state cache and
+	// re-resolved lazily after a hot reload. Record into VulkanRenderer::BeginComputeCommandBuffer
+	// to run on the async compute queue, or into any graphics command buffer to run inline.
+	// Resources shared with graphics need VK_SHARING_MODE_CONCURRENT or an explicit ownership transfer
+	class VulkanComputePipeline : public RefCounted
+	{
+	public:
+		VulkanComputePipeline(const Ref<VulkanShader>& computeShader, const std::string& debugName = "");
+		virtual ~VulkanComputePipeline() = default;
+
+		void Invalidate();
+
+		void Bind(VkCommandBuffer commandBuffer);
+		void BindDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, uint32_t set = 0);
+		void SetPushConstants(VkCommandBuffer commandBuffer, const void* data, uint32_t size, uint32_t offset = 0);
+		void Dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+		VkPipeline GetVulkanPipeline();
+		VkPipelineLayout GetVulkanPipelineLayout();
+
+		Ref<VulkanShader> GetShader() const { return m_Shader; }
+
+	private:
+		Ref<VulkanShader> m_Shader;
+		std::string m_DebugName;
+
+		VkPipeline m_Pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		uint32_t m_ShaderContentHash = 0;
+	};
+
+}
\ No newline at end of file
@@ -1,10 +1,34 @@
 #include "xopch.h"
 #include "VulkanContext.h"
+#include "VulkanRenderer.h"
+
+#include "Xero/Renderer/Renderer.h"
+#include "Xero/Utils/StringUtils.h"
 
 #include <GLFW/glfw3.h>
 
+#include <filesystem>
+
 namespace Xero {
 
+	namespace Utils {
+
+		static const char* GetPipelineCacheDirectory()
+		{
+			// Relative to the working directory, created on the first save
+			return "Resources/Cache/Pipeline/Vulkan";
+		}
+
+		static std::filesystem::path GetPipelineCachePath()
+		{
+			return std::filesystem::path(GetPipelineCacheDirectory()) / "PipelineCache.bin";
+		}
+
+	}
+
+	// How often the pipeline cache is flushed to disk while running
+	static constexpr float s_PipelineCacheSaveInterval = 60.0f;
+
 	VkInstance VulkanContext::s_VulkanInstance = nullptr;
 
 	static bool s_Validation = true;
@@ -26,6 +50,23 @@ namespace Xero {
 
 	}
 
+	void VulkanContext::Shutdown()
+	{
+		// Not from the destructor, the renderer reaches the device through VulkanContext::Get(), which would take a
+		// new Ref to a context whose count already dropped to zero and destroy it a second time
+		VulkanRenderer::Shutdown();
+
+		if (m_PipelineCache)
+		{
+			SavePipelineCache();
+			vkDestroyPipelineCache(m_Device->GetVulkanDevice(), m_PipelineCache, nullptr);
+			m_PipelineCache = VK_NULL_HANDLE;
+		}
+
+		// Reports anything still allocated at this point as a leak, the window has released the swapchain by now
+		VulkanAllocator::Shutdown();
+	}
+
 	void VulkanContext::Init()
 	{
 		//////////////////////////////////////////////////////////////////////////
@@ -43,7 +84,12 @@ namespace Xero {
 		//////////////////////////////////////////////////////////////////////////
 
 		#define VK_KHR_WIN32_SURFACE_EXTENSION_NAME "VK_KHR_win32_surface"
-		std::vector<const char*> instanceExtensions = { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME };
+		std::vector<const char*> instanceExtensions;
+		if (!Renderer::GetConfig().Headless)
+		{
+			instanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+			instanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+		}
 
 		if (s_Validation)
 		{
@@ -119,9 +165,120 @@ namespace Xero {
 
 		VulkanAllocator::Init(m_Device);
 
+		//////////////////////////////////////////////////////////////////////////
+		// Pipeline Cache
+		//////////////////////////////////////////////////////////////////////////
+
+		std::vector<uint8_t> pipelineCacheData = LoadPipelineCacheData();
+
 		VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
 		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheCreateInfo.initialDataSize = pipelineCacheData.size();
+		pipelineCacheCreateInfo.pInitialData = pipelineCacheData.empty() ? nullptr : pipelineCacheData.data();
 		VK_CHECK_RESULT(vkCreatePipelineCache(m_Device->GetVulkanDevice(), &pipelineCacheCreateInfo, nullptr, &m_PipelineCache));
+
+		m_SavedPipelineCacheSize = pipelineCacheData.size();
+		m_PipelineCacheSaveTimer.Reset();
+
+		VulkanRenderer::Init();
+	}
+
+	std::vector<uint8_t> VulkanContext::LoadPipelineCacheData()
+	{
+		std::filesystem::path cachePath = Utils::GetPipelineCachePath();
+
+		std::vector<uint8_t> data;
+		std::ifstream in(cachePath, std::ios::in | std::ios::binary);
+		if (!in)
+		{
+			XO_CORE_INFO("No pipeline cache found at {0}, starting cold", cachePath.string());
+			return data;
+		}
+
+		in.seekg(0, std::ios::end);
+		data.resize((size_t)in.tellg());
+		in.seekg(0, std::ios::beg);
+		in.read((char*)data.data(), data.size());
+		in.close();
+
+		// The driver is allowed to reject or misbehave on data from another device or driver version,
+		// so validate the header ourselves and start cold if anything does not match
+		const VkPhysicalDeviceProperties& properties = m_PhysicalDevice->GetProperties();
+
+		VkPipelineCacheHeaderVersionOne header{};
+		if (data.size() < sizeof(header))
+		{
+			XO_CORE_WARN("Pipeline cache {0} is truncated, ignoring", cachePath.string());
+			return {};
+		}
+
+		memcpy(&header, data.data(), sizeof(header));
+		if (header.headerSize < sizeof(header) || header.headerSize > data.size() ||
+			header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+			header.vendorID != properties.vendorID ||
+			header.deviceID != properties.deviceID ||
+			memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			XO_CORE_WARN("Pipeline cache {0} was created by a different device or driver, ignoring", cachePath.string());
+			return {};
+		}
+
+		XO_CORE_INFO("Loaded pipeline cache {0} ({1})", cachePath.string(), Utils::BytesToString(data.size()));
+		return data;
+	}
+
+	void VulkanContext::SavePipelineCache()
+	{
+		VkDevice device = m_Device->GetVulkanDevice();
+
+		size_t size = 0;
+		VK_CHECK_RESULT(vkGetPipelineCacheData(device, m_PipelineCache, &size, nullptr));
+		if (size == 0)
+			return;
+
+		std::vector<uint8_t> data(size);
+		VK_CHECK_RESULT(vkGetPipelineCacheData(device, m_PipelineCache, &size, data.data()));
+
+		std::filesystem::path cachePath = Utils::GetPipelineCachePath();
+		std::filesystem::create_directories(cachePath.parent_path());
+
+		// Write to a temporary file first so a crash never leaves a truncated cache behind
+		std::filesystem::path tempPath = cachePath;
+		tempPath += ".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				XO_CORE_ERROR("Could not write pipeline cache {0}", cachePath.string());
+				return;
+			}
+			out.write((const char*)data.data(), size);
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, cachePath, error);
+		if (error)
+		{
+			XO_CORE_ERROR("Could not replace pipeline cache {0} ({1})", cachePath.string(), error.message());
+			return;
+		}
+
+		m_SavedPipelineCacheSize = size;
+		XO_CORE_TRACE("Saved pipeline cache {0} ({1})", cachePath.string(), Utils::BytesToString(size));
+	}
+
+	void VulkanContext::SavePipelineCacheIfNeeded()
+	{
+		if (m_PipelineCacheSaveTimer.Elapsed() < s_PipelineCacheSaveInterval)
+			return;
+
+		m_PipelineCacheSaveTimer.Reset();
+
+		// Pipeline caches only ever grow, an unchanged size means nothing new was compiled
+		size_t size = 0;
+		VK_CHECK_RESULT(vkGetPipelineCacheData(m_Device->GetVulkanDevice(), m_PipelineCache, &size, nullptr));
+		if (size != m_SavedPipelineCacheSize)
+			SavePipelineCache();
 	}
 
 }
\ No newline at end of file
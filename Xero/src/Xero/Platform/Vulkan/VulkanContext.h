@@ -2,6 +2,7 @@
 
 #include "Xero/Renderer/RendererContext.h"
 #include "Xero/Renderer/RendererAPI.h"
+#include "Xero/Core/Timer.h"
 
 #include "Vulkan.h"
 #include "VulkanDevice.h"
@@ -17,8 +18,13 @@ namespace Xero {
 		virtual ~VulkanContext();
 
 		virtual void Init() override;
+		virtual void Shutdown() override;
 
 		Ref<VulkanDevice> GetDevice() { return m_Device; }
+		VkPipelineCache GetPipelineCache() const { return m_PipelineCache; }
+
+		void SavePipelineCache();
+		void SavePipelineCacheIfNeeded();
 
 	public:
 		static VkInstance GetInstance() { return s_VulkanInstance; }
@@ -26,6 +32,9 @@ namespace Xero {
 		static Ref<VulkanContext> Get() { return Ref<VulkanContext>(RendererAPI::GetContext()); }
 		static Ref<VulkanDevice> GetCurrentDevice() { return Get()->GetDevice(); }
 
+	private:
+		std::vector<uint8_t> LoadPipelineCacheData();
+
 	private:
 		// Devices
 		Ref<VulkanPhysicalDevice> m_PhysicalDevice;
@@ -34,7 +43,9 @@ namespace Xero {
 		// Vulkan Instance
 		static VkInstance s_VulkanInstance;
 		VkDebugReportCallbackEXT m_DebugReportCallback = VK_NULL_HANDLE;
-		VkPipelineCache m_PipelineCache;
+		VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+		size_t m_SavedPipelineCacheSize = 0;
+		Timer m_PipelineCacheSaveTimer;
 
 	};
 
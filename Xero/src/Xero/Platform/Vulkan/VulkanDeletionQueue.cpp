@@ -0,0 +1,52 @@
+#include "xopch.h"
+#include "VulkanDeletionQueue.h"
+
+namespace Xero {
+
+	VulkanDeletionQueue::~VulkanDeletionQueue()
+	{
+		// The owner idles the device before tearing down, whatever was deferred during teardown runs now
+		FlushAll();
+	}
+
+	void VulkanDeletionQueue::Push(uint64_t frameNumber, std::function<void()>&& func)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		// Keep the queue ordered even if a worker pushes with a stale frame number
+		if (!m_Entries.empty() && m_Entries.back().FrameNumber > frameNumber)
+			frameNumber = m_Entries.back().FrameNumber;
+
+		m_Entries.push_back({ frameNumber, std::move(func) });
+	}
+
+	void VulkanDeletionQueue::Flush(uint64_t completedFrameNumber)
+	{
+		std::vector<std::function<void()>> ready;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			while (!m_Entries.empty() && m_Entries.front().FrameNumber <= completedFrameNumber)
+			{
+				ready.push_back(std::move(m_Entries.front().Func));
+				m_Entries.pop_front();
+			}
+		}
+
+		// Run outside the lock, a destructor is allowed to release further resources
+		for (auto& func : ready)
+			func();
+	}
+
+	void VulkanDeletionQueue::FlushAll()
+	{
+		while (GetPendingCount())
+			Flush(UINT64_MAX);
+	}
+
+	uint32_t VulkanDeletionQueue::GetPendingCount()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		return (uint32_t)m_Entries.size();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+
+namespace Xero {
+
+	// Resource destruction tagged with the frame that submitted it. An entry only runs once
+	// that frame has completed on the GPU, so releasing a resource never stalls the device
+	class VulkanDeletionQueue
+	{
+	public:
+		VulkanDeletionQueue() = default;
+		// Runs the remaining entries, the device has to be idle
+		~VulkanDeletionQueue();
+
+		void Push(uint64_t frameNumber, std::function<void()>&& func);
+
+		// Runs every entry submitted at or before completedFrameNumber
+		void Flush(uint64_t completedFrameNumber);
+		// Only safe once the device is idle
+		void FlushAll();
+
+		uint32_t GetPendingCount();
+
+	private:
+		struct Entry
+		{
+			uint64_t FrameNumber;
+			std::function<void()> Func;
+		};
+
+		std::deque<Entry> m_Entries; // Ordered by frame number
+		std::mutex m_Mutex; // Worker threads may release resources too
+	};
+
+}
\ No newline at end of file
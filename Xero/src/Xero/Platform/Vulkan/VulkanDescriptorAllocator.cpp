@@ -0,0 +1,119 @@
+#include "xopch.h"
+#include "VulkanDescriptorAllocator.h"
+
+namespace Xero {
+
+	// Descriptors reserved per set, by type. Pools are sized for the average shader rather than the worst case
+	static const std::pair<VkDescriptorType, float> s_PoolSizeRatios[] =
+	{
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0.5f },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2.0f }, // Reflected uniform buffers
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f }
+	};
+
+	VulkanDescriptorAllocator::VulkanDescriptorAllocator(VkDevice device, uint32_t initialSetsPerPool, uint32_t maxSetsPerPool)
+		: m_Device(device), m_SetsPerPool(initialSetsPerPool), m_MaxSetsPerPool(maxSetsPerPool)
+	{
+
+	}
+
+	VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+	{
+		Destroy();
+	}
+
+	VkDescriptorSet VulkanDescriptorAllocator::Allocate(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes)
+	{
+		XO_CORE_ASSERT(allocInfo.descriptorSetCount == 1);
+
+		if (!m_CurrentPool)
+			m_CurrentPool = AcquirePool();
+
+		VkDescriptorSet result = VK_NULL_HANDLE;
+		allocInfo.descriptorPool = m_CurrentPool;
+		VkResult allocResult = vkAllocateDescriptorSets(m_Device, &allocInfo, &result);
+
+		// The current pool is exhausted or the set is larger than it, retry once on a pool that fits the set
+		if (allocResult == VK_ERROR_OUT_OF_POOL_MEMORY || allocResult == VK_ERROR_FRAGMENTED_POOL)
+		{
+			m_CurrentPool = AcquirePool(setSizes);
+			allocInfo.descriptorPool = m_CurrentPool;
+			allocResult = vkAllocateDescriptorSets(m_Device, &allocInfo, &result);
+		}
+
+		VK_CHECK_RESULT(allocResult);
+		m_AllocatedSetCount++;
+		return result;
+	}
+
+	void VulkanDescriptorAllocator::Reset()
+	{
+		for (VkDescriptorPool pool : m_UsedPools)
+		{
+			VK_CHECK_RESULT(vkResetDescriptorPool(m_Device, pool, 0));
+			m_FreePools.push_back(pool);
+		}
+
+		m_UsedPools.clear();
+		m_CurrentPool = VK_NULL_HANDLE;
+		m_AllocatedSetCount = 0;
+	}
+
+	void VulkanDescriptorAllocator::Destroy()
+	{
+		if (m_UsedPools.empty() && m_FreePools.empty())
+			return;
+
+		for (VkDescriptorPool pool : m_UsedPools)
+			vkDestroyDescriptorPool(m_Device, pool, nullptr);
+		for (VkDescriptorPool pool : m_FreePools)
+			vkDestroyDescriptorPool(m_Device, pool, nullptr);
+
+		m_UsedPools.clear();
+		m_FreePools.clear();
+		m_CurrentPool = VK_NULL_HANDLE;
+		m_AllocatedSetCount = 0;
+	}
+
+	VkDescriptorPool VulkanDescriptorAllocator::AcquirePool(const std::vector<VkDescriptorPoolSize>& setSizes)
+	{
+		// Recycled pools have the default sizes, a set with known requirements always gets a fresh pool that holds it
+		if (!m_FreePools.empty() && setSizes.empty())
+		{
+			VkDescriptorPool pool = m_FreePools.back();
+			m_FreePools.pop_back();
+			m_UsedPools.push_back(pool);
+			return pool;
+		}
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& [type, ratio] : s_PoolSizeRatios)
+			poolSizes.push_back({ type, (uint32_t)(ratio * m_SetsPerPool) });
+
+		for (const auto& setSize : setSizes)
+		{
+			auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [&setSize](const VkDescriptorPoolSize& size) { return size.type == setSize.type; });
+			if (it == poolSizes.end())
+				poolSizes.push_back(setSize);
+			else
+				it->descriptorCount = std::max(it->descriptorCount, setSize.descriptorCount);
+		}
+
+		VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+		descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolInfo.poolSizeCount = (uint32_t)poolSizes.size();
+		descriptorPoolInfo.pPoolSizes = poolSizes.data();
+		descriptorPoolInfo.maxSets = m_SetsPerPool;
+
+		VkDescriptorPool pool;
+		VK_CHECK_RESULT(vkCreateDescriptorPool(m_Device, &descriptorPoolInfo, nullptr, &pool));
+		m_UsedPools.push_back(pool);
+
+		// Grow geometrically so a busy allocator settles on a handful of pools
+		m_SetsPerPool = std::min(m_SetsPerPool * 2, m_MaxSetsPerPool);
+		return pool;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Vulkan.h"
+
+namespace Xero {
+
+	// Hands out descriptor sets from a chain of pools. When the current pool runs dry a new,
+	// larger one is appended, and Reset recycles every pool in one call instead of freeing sets
+	class VulkanDescriptorAllocator
+	{
+	public:
+		// The device is taken up front, allocators may be created and used on worker threads
+		VulkanDescriptorAllocator(VkDevice device, uint32_t initialSetsPerPool = 64, uint32_t maxSetsPerPool = 4096);
+		~VulkanDescriptorAllocator();
+
+		// setSizes are the descriptors the set needs by type. When the set does not fit a default pool the retry
+		// gets a pool sized for it
+		VkDescriptorSet Allocate(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes = {});
+		void Reset();
+		void Destroy();
+
+		uint32_t GetPoolCount() const { return (uint32_t)(m_UsedPools.size() + m_FreePools.size()); }
+		uint32_t GetAllocatedSetCount() const { return m_AllocatedSetCount; }
+
+	private:
+		VkDescriptorPool AcquirePool(const std::vector<VkDescriptorPoolSize>& setSizes = {});
+
+	private:
+		VkDevice m_Device;
+		VkDescriptorPool m_CurrentPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorPool> m_UsedPools;
+		std::vector<VkDescriptorPool> m_FreePools;
+
+		uint32_t m_SetsPerPool;
+		uint32_t m_MaxSetsPerPool;
+		uint32_t m_AllocatedSetCount = 0;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "xopch.h"
+#include "VulkanDescriptorSetLayoutCache.h"
+
+#include "VulkanContext.h"
+
+namespace Xero {
+
+	VulkanDescriptorSetLayoutCache::~VulkanDescriptorSetLayoutCache()
+	{
+		Destroy();
+	}
+
+	VkDescriptorSetLayout VulkanDescriptorSetLayoutCache::GetOrCreate(const VkDescriptorSetLayoutCreateInfo& createInfo)
+	{
+		XO_CORE_ASSERT(createInfo.pNext == nullptr, "Extended layout create infos are not cached");
+
+		LayoutKey key;
+		key.Flags = createInfo.flags;
+		key.Bindings.assign(createInfo.pBindings, createInfo.pBindings + createInfo.bindingCount);
+		std::sort(key.Bindings.begin(), key.Bindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+
+		XO_CORE_ASSERT(std::none_of(key.Bindings.begin(), key.Bindings.end(), [](const auto& binding) { return binding.pImmutableSamplers != nullptr; }),
+			"Immutable samplers are not part of the cache key");
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		auto it = m_Layouts.find(key);
+		if (it != m_Layouts.end())
+		{
+			m_HitCount++;
+			return it->second;
+		}
+
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		VkDescriptorSetLayout layout;
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &createInfo, nullptr, &layout));
+
+		m_Layouts[std::move(key)] = layout;
+		return layout;
+	}
+
+	void VulkanDescriptorSetLayoutCache::Destroy()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		if (m_Layouts.empty())
+			return;
+
+		XO_CORE_TRACE("VulkanDescriptorSetLayoutCache: destroying {0} layouts ({1} cache hits)", m_Layouts.size(), m_HitCount);
+
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		for (auto& [key, layout] : m_Layouts)
+			vkDestroyDescriptorSetLayout(device, layout, nullptr);
+
+		m_Layouts.clear();
+		m_HitCount = 0;
+	}
+
+	bool VulkanDescriptorSetLayoutCache::LayoutKey::operator==(const LayoutKey& other) const
+	{
+		if (Flags != other.Flags || Bindings.size() != other.Bindings.size())
+			return false;
+
+		for (size_t i = 0; i < Bindings.size(); i++)
+		{
+			const auto& a = Bindings[i];
+			const auto& b = other.Bindings[i];
+			if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags)
+				return false;
+		}
+
+		return true;
+	}
+
+	size_t VulkanDescriptorSetLayoutCache::LayoutKeyHasher::operator()(const LayoutKey& key) const
+	{
+		size_t result = std::hash<uint32_t>{}(key.Flags);
+		for (const auto& binding : key.Bindings)
+		{
+			size_t bindingHash = binding.binding | ((size_t)binding.descriptorType << 8) | ((size_t)binding.descriptorCount << 16) | ((size_t)binding.stageFlags << 32);
+			result ^= std::hash<size_t>{}(bindingHash) + 0x9e3779b9 + (result << 6) + (result >> 2);
+		}
+
+		return result;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Vulkan.h"
+
+#include <mutex>
+
+namespace Xero {
+
+	// Hash-consed descriptor set layouts, identical binding lists resolve to the same handle.
+	// The cache owns every layout it returns, they live until Shutdown
+	class VulkanDescriptorSetLayoutCache
+	{
+	public:
+		VulkanDescriptorSetLayoutCache() = default;
+		~VulkanDescriptorSetLayoutCache();
+
+		VkDescriptorSetLayout GetOrCreate(const VkDescriptorSetLayoutCreateInfo& createInfo);
+		void Destroy();
+
+		uint32_t GetLayoutCount() const { return (uint32_t)m_Layouts.size(); }
+		uint32_t GetHitCount() const { return m_HitCount; }
+
+	private:
+		struct LayoutKey
+		{
+			VkDescriptorSetLayoutCreateFlags Flags = 0;
+			std::vector<VkDescriptorSetLayoutBinding> Bindings; // Sorted by binding
+
+			bool operator==(const LayoutKey& other) const;
+		};
+
+		struct LayoutKeyHasher
+		{
+			size_t operator()(const LayoutKey& key) const;
+		};
+
+	private:
+		std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHasher> m_Layouts;
+		uint32_t m_HitCount = 0;
+		std::mutex m_Mutex; // Hot reloads create layouts on worker threads
+	};
+
+}
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "VulkanContext.h"
 
+#include "Xero/Renderer/Renderer.h"
+
 namespace Xero {
 
 	//////////////////////////////////////////////////////////////////////////
@@ -242,9 +244,13 @@ namespace Xero {
 	{
 		std::vector<const char*> deviceExtensions;
 
-		// If the device will be used for presenting to a display via a swapchain we need to request the swapchain extensions
-		XO_CORE_ASSERT(m_PhysicalDevice->IsExtensionSupported(VK_KHR_SWAPCHAIN_EXTENSION_NAME));
-		deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		// If the device will be used for presenting to a display via a swapchain we need to request the swapchain extensions.
+		// Headless devices only render offscreen, so software rasterizers without presentation support work too
+		if (!Renderer::GetConfig().Headless)
+		{
+			XO_CORE_ASSERT(m_PhysicalDevice->IsExtensionSupported(VK_KHR_SWAPCHAIN_EXTENSION_NAME));
+			deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
 
 		VkDeviceCreateInfo deviceCreateInfo{};
 		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -252,8 +258,45 @@ namespace Xero {
 		deviceCreateInfo.pQueueCreateInfos = physicalDevice->m_QueueCreateInfos.data();
 		deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
-		// If a pNext(chain) has been passed, we need to add it to the device creation info
-		VkPhysicalDeviceFeatures2 physicalDeviceFeatures2{};
+		// Timeline semaphores are core in 1.2 but still have to be enabled
+		VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+		supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &supportedFeatures12;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice->GetVulkanPhysicalDevice(), &supportedFeatures);
+		XO_CORE_ASSERT(supportedFeatures12.timelineSemaphore, "Timeline semaphores are required");
+
+		VkPhysicalDeviceVulkan12Features enabledFeatures12{};
+		enabledFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		enabledFeatures12.timelineSemaphore = VK_TRUE;
+		// Optional, the GPU profiler resets its query pools from the host when available
+		enabledFeatures12.hostQueryReset = supportedFeatures12.hostQueryReset;
+		m_HostQueryResetEnabled = supportedFeatures12.hostQueryReset;
+		// Optional, backs the bindless descriptor table. Only enabled as a whole
+		m_DescriptorIndexingEnabled = supportedFeatures12.descriptorIndexing
+			&& supportedFeatures12.runtimeDescriptorArray
+			&& supportedFeatures12.descriptorBindingPartiallyBound
+			&& supportedFeatures12.descriptorBindingSampledImageUpdateAfterBind
+			&& supportedFeatures12.descriptorBindingStorageBufferUpdateAfterBind
+			&& supportedFeatures12.descriptorBindingStorageImageUpdateAfterBind
+			&& supportedFeatures12.descriptorBindingUpdateUnusedWhilePending
+			&& supportedFeatures12.shaderSampledImageArrayNonUniformIndexing
+			&& supportedFeatures12.shaderStorageBufferArrayNonUniformIndexing;
+		if (m_DescriptorIndexingEnabled)
+		{
+			enabledFeatures12.descriptorIndexing = VK_TRUE;
+			enabledFeatures12.runtimeDescriptorArray = VK_TRUE;
+			enabledFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+			enabledFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			enabledFeatures12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+			enabledFeatures12.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+			enabledFeatures12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			enabledFeatures12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+			enabledFeatures12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+			enabledFeatures12.shaderStorageImageArrayNonUniformIndexing = supportedFeatures12.shaderStorageImageArrayNonUniformIndexing;
+		}
+		deviceCreateInfo.pNext = &enabledFeatures12;
 
 		// Enable the debug marker extension if it's present
 		if (m_PhysicalDevice->IsExtensionSupported(VK_EXT_DEBUG_MARKER_EXTENSION_NAME))
@@ -270,71 +313,95 @@ namespace Xero {
 
 		VK_CHECK_RESULT(vkCreateDevice(m_PhysicalDevice->GetVulkanPhysicalDevice(), &deviceCreateInfo, nullptr, &m_LogicalDevice));
 
-		VkCommandPoolCreateInfo cmdPoolInfo{};
-		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		cmdPoolInfo.queueFamilyIndex = m_PhysicalDevice->m_QueueFamilyIndices.Graphics;
-		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		VK_CHECK_RESULT(vkCreateCommandPool(m_LogicalDevice, &cmdPoolInfo, nullptr, &m_CommandPool));
-
 		// Get a graphics queue from the device
 		vkGetDeviceQueue(m_LogicalDevice, m_PhysicalDevice->m_QueueFamilyIndices.Graphics, 0, &m_GraphicsQueue);
+		// The transfer family always has a queue, it either got its own create info or shares one with graphics/compute
+		vkGetDeviceQueue(m_LogicalDevice, m_PhysicalDevice->m_QueueFamilyIndices.Transfer, 0, &m_TransferQueue);
+		vkGetDeviceQueue(m_LogicalDevice, m_PhysicalDevice->m_QueueFamilyIndices.Compute, 0, &m_ComputeQueue);
+
+		for (auto& timeline : m_Timelines)
+			timeline = CreateScope<VulkanTimelineSemaphore>(m_LogicalDevice);
 	}
 
 	VulkanDevice::~VulkanDevice()
 	{
-
+		for (auto& [threadID, commandPool] : m_CommandPools)
+			vkDestroyCommandPool(m_LogicalDevice, commandPool, nullptr);
 	}
 
-	VkCommandBuffer VulkanDevice::GetCommandBuffer(bool begin)
+	VkQueue VulkanDevice::GetQueue(VulkanQueueType queue)
 	{
-		VkCommandBuffer cmdBuffer;
-
-		VkCommandBufferAllocateInfo cmdBufAllocInfo{};
-		cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		cmdBufAllocInfo.commandPool = m_CommandPool;
-		cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		cmdBufAllocInfo.commandBufferCount = 1;
-
-		VK_CHECK_RESULT(vkAllocateCommandBuffers(m_LogicalDevice, &cmdBufAllocInfo, &cmdBuffer));
-
-		// If requested, also start the new command buffer
-		if (begin)
+		switch (queue)
 		{
-			VkCommandBufferBeginInfo cmdBufferBeginInfo{};
-			cmdBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			VK_CHECK_RESULT(vkBeginCommandBuffer(cmdBuffer, &cmdBufferBeginInfo));
+			case VulkanQueueType::Graphics: return m_GraphicsQueue;
+			case VulkanQueueType::Compute:  return m_ComputeQueue;
+			case VulkanQueueType::Transfer: return m_TransferQueue;
 		}
 
-		return cmdBuffer;
+		XO_CORE_ASSERT(false, "Unknown queue type");
+		return VK_NULL_HANDLE;
 	}
 
-	void VulkanDevice::FlushCommandBuffer(VkCommandBuffer commandBuffer)
+	uint64_t VulkanDevice::Submit(VulkanQueueType queue, const VkSubmitInfo& submitInfo, VkFence fence, const std::vector<VulkanTimelineWait>& timelineWaits)
 	{
-		const uint64_t DEFAULT_FENCE_TIMEOUT = 100000000000;
-		XO_CORE_ASSERT(commandBuffer != VK_NULL_HANDLE);
+		// Binary semaphores take a dummy value in the parallel value arrays
+		std::vector<VkSemaphore> waitSemaphores(submitInfo.pWaitSemaphores, submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount);
+		std::vector<VkPipelineStageFlags> waitStages(submitInfo.pWaitDstStageMask, submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount);
+		std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+		for (const auto& wait : timelineWaits)
+		{
+			waitSemaphores.push_back(GetTimeline(wait.Queue).GetVulkanSemaphore());
+			waitStages.push_back(wait.StageMask);
+			waitValues.push_back(wait.Value);
+		}
+
+		VulkanTimelineSemaphore& timeline = GetTimeline(queue);
+		std::vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+		std::vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+		signalSemaphores.push_back(timeline.GetVulkanSemaphore());
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.pNext = submitInfo.pNext;
 
-		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+		VkSubmitInfo timelineSubmitInfo = submitInfo;
+		timelineSubmitInfo.pNext = &timelineInfo;
+		timelineSubmitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+		timelineSubmitInfo.pWaitSemaphores = waitSemaphores.data();
+		timelineSubmitInfo.pWaitDstStageMask = waitStages.data();
+		timelineSubmitInfo.signalSemaphoreCount = (uint32_t)signalSemaphores.size();
+		timelineSubmitInfo.pSignalSemaphores = signalSemaphores.data();
 
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
+		// Values have to reach the queue in increasing order, so reserve and submit under the same lock
+		std::scoped_lock<std::mutex> lock(m_SubmitMutex);
 
-		// Create fence to ensure that the command buffer has finished executing
-		VkFenceCreateInfo fenceCreateInfo{};
-		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceCreateInfo.flags = 0;
+		uint64_t value = timeline.AcquireNextValue();
+		signalValues.push_back(value);
 
-		VkFence fence;
-		VK_CHECK_RESULT(vkCreateFence(m_LogicalDevice, &fenceCreateInfo, nullptr, &fence));
+		timelineInfo.waitSemaphoreValueCount = (uint32_t)waitValues.size();
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = (uint32_t)signalValues.size();
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
 
-		// Submit to the queue
-		VK_CHECK_RESULT(vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, fence));
-		// Wait for the fence to signal that command buffer has finished executing
-		VK_CHECK_RESULT(vkWaitForFences(m_LogicalDevice, 1, &fence, VK_TRUE, DEFAULT_FENCE_TIMEOUT));
+		VK_CHECK_RESULT(vkQueueSubmit(GetQueue(queue), 1, &timelineSubmitInfo, fence));
+		return value;
+	}
+
+	VkCommandPool VulkanDevice::GetThreadCommandPool()
+	{
+		std::scoped_lock<std::mutex> lock(m_CommandPoolMutex);
+
+		VkCommandPool& commandPool = m_CommandPools[std::this_thread::get_id()];
+		if (!commandPool)
+		{
+			VkCommandPoolCreateInfo cmdPoolInfo{};
+			cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			cmdPoolInfo.queueFamilyIndex = m_PhysicalDevice->m_QueueFamilyIndices.Graphics;
+			cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			VK_CHECK_RESULT(vkCreateCommandPool(m_LogicalDevice, &cmdPoolInfo, nullptr, &commandPool));
+		}
 
-		vkDestroyFence(m_LogicalDevice, fence, nullptr);
-		vkFreeCommandBuffers(m_LogicalDevice, m_CommandPool, 1, &commandBuffer);
+		return commandPool;
 	}
 
 	VkCommandBuffer VulkanDevice::CreateSecondaryCommandBuffer()
@@ -343,7 +410,7 @@ namespace Xero {
 
 		VkCommandBufferAllocateInfo cmdBufAllocInfo{};
 		cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		cmdBufAllocInfo.commandPool = m_CommandPool;
+		cmdBufAllocInfo.commandPool = GetThreadCommandPool();
 		cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
 		cmdBufAllocInfo.commandBufferCount = 1;
 
@@ -3,6 +3,10 @@
 #include "Xero/Core/Ref.h"
 
 #include "Vulkan.h"
+#include "VulkanTimelineSemaphore.h"
+
+#include <mutex>
+#include <thread>
 
 namespace Xero {
 
@@ -30,7 +34,9 @@ namespace Xero {
 		VkPhysicalDevice GetVulkanPhysicalDevice() const { return m_PhysicalDevice; }
 		const QueueFamilyIndices& GetQueueFamilyIndices() const { return m_QueueFamilyIndices; }
 
+		const VkPhysicalDeviceProperties& GetProperties() const { return m_Properties; }
 		const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_MemoryProperties; }
+		const std::vector<VkQueueFamilyProperties>& GetQueueFamilyProperties() const { return m_QueueFamilyProperties; }
 
 		VkFormat GetDepthFormat() const { return m_DepthFormat; }
 
@@ -61,6 +67,19 @@ namespace Xero {
 	// Device
 	//////////////////////////////////////////////////////////////////////////
 
+	enum class VulkanQueueType
+	{
+		Graphics = 0, Compute, Transfer
+	};
+
+	// Wait for another queue's timeline to reach Value before StageMask runs
+	struct VulkanTimelineWait
+	{
+		VulkanQueueType Queue = VulkanQueueType::Graphics;
+		uint64_t Value = 0;
+		VkPipelineStageFlags StageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	};
+
 	class VulkanDevice : public RefCounted
 	{
 	public:
@@ -68,24 +87,51 @@ namespace Xero {
 		~VulkanDevice();
 
 		VkQueue GetGraphicsQueue() { return m_GraphicsQueue; }
-
-		VkCommandBuffer GetCommandBuffer(bool begin);
-		void FlushCommandBuffer(VkCommandBuffer commandBuffer);
-
+		// Falls back to the graphics queue when the device has no separate transfer family
+		VkQueue GetTransferQueue() { return m_TransferQueue; }
+		// Same fallback as transfer, on devices without a separate family compute work serializes with graphics
+		VkQueue GetComputeQueue() { return m_ComputeQueue; }
+		VkQueue GetQueue(VulkanQueueType queue);
+
+		// Every submit goes through here. It is serialized across threads, additionally signals the queue's
+		// timeline and returns the value that marks its completion
+		uint64_t Submit(VulkanQueueType queue, const VkSubmitInfo& submitInfo, VkFence fence = VK_NULL_HANDLE, const std::vector<VulkanTimelineWait>& timelineWaits = {});
+		VulkanTimelineSemaphore& GetTimeline(VulkanQueueType queue) { return *m_Timelines[(uint32_t)queue]; }
+		// For queue operations that are not submits, e.g. present
+		std::mutex& GetQueueMutex() { return m_SubmitMutex; }
+
+		// One-shot work goes through VulkanRenderer::GetImmediateSubmitter
 		VkCommandBuffer CreateSecondaryCommandBuffer();
 
 		const Ref<VulkanPhysicalDevice>& GetPhysicalDevice() const { return m_PhysicalDevice; }
 		VkDevice GetVulkanDevice() const { return m_LogicalDevice; }
 
+		// Query pools can be reset from the host instead of from a command buffer
+		bool IsHostQueryResetEnabled() const { return m_HostQueryResetEnabled; }
+		// Runtime arrays, partially bound and update-after-bind descriptors, see VulkanBindlessTable
+		bool IsDescriptorIndexingEnabled() const { return m_DescriptorIndexingEnabled; }
+
+	private:
+		// Command pools must not be used from two threads at once, every thread gets its own
+		VkCommandPool GetThreadCommandPool();
+
 	private:
 		VkDevice m_LogicalDevice = nullptr;
 		Ref<VulkanPhysicalDevice> m_PhysicalDevice;
 		VkPhysicalDeviceFeatures m_EnabledFeatures;
-		VkCommandPool m_CommandPool;
+		std::unordered_map<std::thread::id, VkCommandPool> m_CommandPools;
+		std::mutex m_CommandPoolMutex;
 
 		VkQueue m_GraphicsQueue;
+		VkQueue m_TransferQueue;
+		VkQueue m_ComputeQueue;
+
+		Scope<VulkanTimelineSemaphore> m_Timelines[3];
+		std::mutex m_SubmitMutex; // Queues may alias each other, so one lock covers all of them
 
 		bool m_EnabledDebugMarkers = false;
+		bool m_HostQueryResetEnabled = false;
+		bool m_DescriptorIndexingEnabled = false;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "xopch.h"
+#include "VulkanFrameContext.h"
+
+#include "VulkanContext.h"
+#include "VulkanRenderer.h"
+
+namespace Xero {
+
+	static constexpr VkDeviceSize s_InitialUploadBufferSize = 4 * 1024 * 1024;
+
+	VulkanFrameContext::VulkanFrameContext(uint32_t index)
+		: m_Index(index)
+	{
+		auto device = VulkanContext::GetCurrentDevice();
+		m_Device = device->GetVulkanDevice();
+		m_GraphicsQueueFamilyIndex = device->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
+
+		VkCommandPoolCreateInfo cmdPoolInfo = {};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		cmdPoolInfo.queueFamilyIndex = device->GetPhysicalDevice()->GetQueueFamilyIndices().Compute;
+		VK_CHECK_RESULT(vkCreateCommandPool(m_Device, &cmdPoolInfo, nullptr, &m_ComputeCommandPool));
+
+		CreateUploadBuffer(s_InitialUploadBufferSize);
+	}
+
+	VulkanFrameContext::~VulkanFrameContext()
+	{
+		DestroyUploadBuffer();
+
+		vkDestroyCommandPool(m_Device, m_ComputeCommandPool, nullptr);
+		for (auto& [threadID, threadResources] : m_ThreadResources)
+		{
+			vkDestroyCommandPool(m_Device, threadResources->Pool, nullptr);
+			threadResources->DescriptorAllocator.Destroy();
+		}
+	}
+
+	void VulkanFrameContext::Begin(uint64_t frameNumber)
+	{
+		m_FrameNumber = frameNumber;
+
+		{
+			std::scoped_lock<std::mutex> lock(m_ThreadResourcesMutex);
+			for (auto& [threadID, threadResources] : m_ThreadResources)
+			{
+				VK_CHECK_RESULT(vkResetCommandPool(m_Device, threadResources->Pool, 0));
+				threadResources->UsedPrimaryCommandBuffers = 0;
+				threadResources->UsedSecondaryCommandBuffers = 0;
+				threadResources->DescriptorAllocator.Reset();
+			}
+		}
+
+		// Every compute submit was waited on by this slot's graphics submit, so its timeline value covers them too
+		VK_CHECK_RESULT(vkResetCommandPool(m_Device, m_ComputeCommandPool, 0));
+		m_UsedComputeCommandBuffers = 0;
+
+		m_GraphicsTimelineWaits.clear();
+
+		m_UploadOffset = 0;
+	}
+
+	VkCommandBuffer VulkanFrameContext::AllocateCommandBuffer(bool secondary)
+	{
+		ThreadResources& threadResources = GetThreadResources();
+		auto& commandBuffers = secondary ? threadResources.SecondaryCommandBuffers : threadResources.PrimaryCommandBuffers;
+		uint32_t& usedCount = secondary ? threadResources.UsedSecondaryCommandBuffers : threadResources.UsedPrimaryCommandBuffers;
+
+		// Buffers are kept across frames, resetting the pool only returns them to the initial state
+		if (usedCount == commandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = threadResources.Pool;
+			allocateInfo.level = secondary ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer));
+			commandBuffers.push_back(commandBuffer);
+		}
+
+		return commandBuffers[usedCount++];
+	}
+
+	VulkanFrameContext::ThreadResources& VulkanFrameContext::GetThreadResources()
+	{
+		std::scoped_lock<std::mutex> lock(m_ThreadResourcesMutex);
+
+		Scope<ThreadResources>& threadResources = m_ThreadResources[std::this_thread::get_id()];
+		if (!threadResources)
+		{
+			threadResources = CreateScope<ThreadResources>(m_Device);
+
+			VkCommandPoolCreateInfo cmdPoolInfo = {};
+			cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			cmdPoolInfo.queueFamilyIndex = m_GraphicsQueueFamilyIndex;
+			cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			VK_CHECK_RESULT(vkCreateCommandPool(m_Device, &cmdPoolInfo, nullptr, &threadResources->Pool));
+		}
+
+		// Entries live as long as the frame context, the reference stays valid after unlocking
+		return *threadResources;
+	}
+
+	VkCommandBuffer VulkanFrameContext::AllocateComputeCommandBuffer()
+	{
+		if (m_UsedComputeCommandBuffers == m_ComputeCommandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = m_ComputeCommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer));
+			m_ComputeCommandBuffers.push_back(commandBuffer);
+		}
+
+		return m_ComputeCommandBuffers[m_UsedComputeCommandBuffers++];
+	}
+
+	VulkanFrameContext::UploadAllocation VulkanFrameContext::AllocateUpload(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		VkDeviceSize offset = (m_UploadOffset + alignment - 1) & ~(alignment - 1);
+		if (offset + size > m_UploadSize)
+		{
+			// Earlier allocations this frame still point into the old buffer, retire it with the frame
+			DestroyUploadBuffer();
+			CreateUploadBuffer(std::max(m_UploadSize * 2, size));
+			offset = 0;
+		}
+
+		m_UploadOffset = offset + size;
+		return { m_UploadBuffer, offset, m_UploadData + offset };
+	}
+
+	void VulkanFrameContext::CreateUploadBuffer(VkDeviceSize size)
+	{
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator("FrameUpload");
+		m_UploadAllocation = allocator.AllocateBuffer(bufferCreateInfo, "Transient", m_UploadBuffer);
+		m_UploadData = allocator.MapMemory<uint8_t>(m_UploadAllocation);
+		m_UploadSize = size;
+		m_UploadOffset = 0;
+	}
+
+	void VulkanFrameContext::DestroyUploadBuffer()
+	{
+		if (!m_UploadBuffer)
+			return;
+
+		VulkanAllocator allocator("FrameUpload");
+		allocator.UnmapMemory(m_UploadAllocation);
+		allocator.DestroyBuffer(m_UploadBuffer, m_UploadAllocation);
+
+		m_UploadBuffer = VK_NULL_HANDLE;
+		m_UploadAllocation = nullptr;
+		m_UploadData = nullptr;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanAllocator.h"
+#include "VulkanDescriptorAllocator.h"
+
+#include <mutex>
+#include <thread>
+
+namespace Xero {
+
+	// Everything owned by one frame in flight. Begin is only called once the submit of the
+	// frame that last used this slot has completed, so all of it can be recycled without waiting
+	class VulkanFrameContext
+	{
+	public:
+		struct UploadAllocation
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VkDeviceSize Offset = 0;
+			void* Data = nullptr;
+		};
+
+	public:
+		VulkanFrameContext(uint32_t index);
+		~VulkanFrameContext();
+
+		void Begin(uint64_t frameNumber);
+
+		// Primary or secondary command buffers from the calling thread's pool for this frame, reset in bulk each frame.
+		// Pools are never shared between threads, so worker threads can record without locking. Nothing on this path
+		// touches a Ref, the refcount is not atomic
+		VkCommandBuffer AllocateCommandBuffer(bool secondary = false);
+
+		// Command buffers from the compute family's pool, see VulkanRenderer::SubmitCompute
+		VkCommandBuffer AllocateComputeCommandBuffer();
+
+		// Timeline values the graphics submit of this frame has to wait on, e.g. reached by async compute
+		void AddGraphicsTimelineWait(const VulkanTimelineWait& wait) { m_GraphicsTimelineWaits.push_back(wait); }
+		const std::vector<VulkanTimelineWait>& GetGraphicsTimelineWaits() const { return m_GraphicsTimelineWaits; }
+
+		// Host-visible linear allocation, valid until this frame slot comes round again
+		UploadAllocation AllocateUpload(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+		// Transient descriptor sets, the calling thread's allocator like the command pools
+		VulkanDescriptorAllocator& GetDescriptorAllocator() { return GetThreadResources().DescriptorAllocator; }
+
+		uint32_t GetIndex() const { return m_Index; }
+		uint64_t GetFrameNumber() const { return m_FrameNumber; }
+
+	private:
+		struct ThreadResources
+		{
+			VkCommandPool Pool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> PrimaryCommandBuffers;
+			std::vector<VkCommandBuffer> SecondaryCommandBuffers;
+			uint32_t UsedPrimaryCommandBuffers = 0;
+			uint32_t UsedSecondaryCommandBuffers = 0;
+
+			VulkanDescriptorAllocator DescriptorAllocator;
+
+			ThreadResources(VkDevice device)
+				: DescriptorAllocator(device) {}
+		};
+
+		ThreadResources& GetThreadResources();
+		void CreateUploadBuffer(VkDeviceSize size);
+		void DestroyUploadBuffer();
+
+	private:
+		uint32_t m_Index;
+		uint64_t m_FrameNumber = 0;
+
+		// Taken on the main thread, workers use these instead of going through the context
+		VkDevice m_Device = VK_NULL_HANDLE;
+		uint32_t m_GraphicsQueueFamilyIndex = 0;
+
+		std::unordered_map<std::thread::id, Scope<ThreadResources>> m_ThreadResources;
+		std::mutex m_ThreadResourcesMutex; // Guards the map only, each entry belongs to one thread
+
+		VkCommandPool m_ComputeCommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> m_ComputeCommandBuffers;
+		uint32_t m_UsedComputeCommandBuffers = 0;
+
+		std::vector<VulkanTimelineWait> m_GraphicsTimelineWaits;
+
+		VkBuffer m_UploadBuffer = VK_NULL_HANDLE;
+		VmaAllocation m_UploadAllocation = nullptr;
+		uint8_t* m_UploadData = nullptr;
+		VkDeviceSize m_UploadSize = 0;
+		VkDeviceSize m_UploadOffset = 0;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "xopch.h"
+#include "VulkanGPUProfiler.h"
+
+#include "VulkanContext.h"
+#include "VulkanRenderer.h"
+
+#include "imgui.h"
+
+namespace Xero {
+
+	VulkanGPUProfiler::VulkanGPUProfiler(uint32_t framesInFlight, uint32_t maxScopesPerFrame)
+		: m_MaxScopesPerFrame(maxScopesPerFrame)
+	{
+		auto device = VulkanContext::GetCurrentDevice();
+		const auto& physicalDevice = device->GetPhysicalDevice();
+
+		// Timestamps recorded on other queues are only comparable when the graphics family supports them too
+		uint32_t graphicsFamily = physicalDevice->GetQueueFamilyIndices().Graphics;
+		uint32_t validBits = physicalDevice->GetQueueFamilyProperties()[graphicsFamily].timestampValidBits;
+		m_Supported = validBits > 0;
+		if (!m_Supported)
+		{
+			XO_CORE_WARN("VulkanGPUProfiler: the graphics queue does not support timestamps, GPU profiling is disabled");
+			return;
+		}
+
+		m_TimestampPeriod = physicalDevice->GetProperties().limits.timestampPeriod;
+		m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = maxScopesPerFrame * 2;
+
+		m_Frames.resize(framesInFlight);
+		for (auto& frame : m_Frames)
+			VK_CHECK_RESULT(vkCreateQueryPool(device->GetVulkanDevice(), &queryPoolInfo, nullptr, &frame.QueryPool));
+	}
+
+	VulkanGPUProfiler::~VulkanGPUProfiler()
+	{
+		// Owned by the renderer, which waits for the device before tearing down
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		for (auto& frame : m_Frames)
+			vkDestroyQueryPool(device, frame.QueryPool, nullptr);
+	}
+
+	void VulkanGPUProfiler::BeginFrame(uint32_t frameIndex, uint64_t frameNumber)
+	{
+		if (!m_Supported)
+			return;
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		m_CurrentFrameIndex = frameIndex;
+		FrameQueries& frame = m_Frames[frameIndex];
+
+		// Nothing was written the first time round, the pool has not even been reset yet
+		if (!frame.Scopes.empty())
+			ReadResults(frame);
+
+		frame.Scopes.clear();
+		frame.OpenScopeCount.clear();
+		frame.FrameNumber = frameNumber;
+
+		uint32_t queryCount = m_MaxScopesPerFrame * 2;
+		if (VulkanContext::GetCurrentDevice()->IsHostQueryResetEnabled())
+		{
+			vkResetQueryPool(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), frame.QueryPool, 0, queryCount);
+		}
+		else
+		{
+			// Flushed on the graphics queue ahead of this frame's submit, so the reset lands before any timestamp
+			VkQueryPool queryPool = frame.QueryPool;
+			VulkanRenderer::GetImmediateSubmitter().SubmitAsync([queryPool, queryCount](VkCommandBuffer commandBuffer)
+			{
+				vkCmdResetQueryPool(commandBuffer, queryPool, 0, queryCount);
+			});
+		}
+	}
+
+	uint32_t VulkanGPUProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name)
+	{
+		if (!m_Supported)
+			return UINT32_MAX;
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		FrameQueries& frame = m_Frames[m_CurrentFrameIndex];
+		if (frame.Scopes.size() >= m_MaxScopesPerFrame)
+			return UINT32_MAX;
+
+		uint32_t scopeIndex = (uint32_t)frame.Scopes.size();
+		uint32_t& openScopes = frame.OpenScopeCount[commandBuffer];
+		frame.Scopes.push_back({ name, openScopes++ });
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.QueryPool, scopeIndex * 2);
+		return scopeIndex;
+	}
+
+	void VulkanGPUProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scopeIndex)
+	{
+		if (scopeIndex == UINT32_MAX)
+			return;
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		FrameQueries& frame = m_Frames[m_CurrentFrameIndex];
+		frame.OpenScopeCount[commandBuffer]--;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.QueryPool, scopeIndex * 2 + 1);
+	}
+
+	float VulkanGPUProfiler::GetScopeTime(const std::string& name) const
+	{
+		for (const auto& result : m_Results)
+		{
+			if (result.Name == name)
+				return result.Milliseconds;
+		}
+		return 0.0f;
+	}
+
+	void VulkanGPUProfiler::ReadResults(FrameQueries& frame)
+	{
+		// Value and availability per query. No wait flag: scopes in command buffers that were never submitted
+		// stay unavailable and are skipped
+		uint32_t queryCount = (uint32_t)frame.Scopes.size() * 2;
+		std::vector<uint64_t> queryData(queryCount * 2);
+		VkResult result = vkGetQueryPoolResults(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), frame.QueryPool, 0, queryCount,
+			queryData.size() * sizeof(uint64_t), queryData.data(), sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result != VK_SUCCESS && result != VK_NOT_READY)
+			VK_CHECK_RESULT(result);
+
+		m_Results.clear();
+		m_Results.reserve(frame.Scopes.size());
+		for (uint32_t i = 0; i < (uint32_t)frame.Scopes.size(); i++)
+		{
+			const uint64_t* begin = &queryData[i * 4];
+			const uint64_t* end = &queryData[i * 4 + 2];
+			if (!begin[1] || !end[1])
+				continue;
+
+			uint64_t ticks = ((end[0] - begin[0]) & m_TimestampMask);
+			m_Results.push_back({ frame.Scopes[i].Name, frame.Scopes[i].Depth, (float)((double)ticks * m_TimestampPeriod / 1000000.0) });
+		}
+		m_ResultsFrameNumber = frame.FrameNumber;
+	}
+
+	void VulkanGPUProfiler::OnImGuiRender()
+	{
+		ImGui::Begin("GPU Profiler");
+
+		if (!m_Supported)
+		{
+			ImGui::Text("Timestamp queries are not supported on this device");
+			ImGui::End();
+			return;
+		}
+
+		ImGui::Text("Frame %llu", (unsigned long long)m_ResultsFrameNumber);
+		ImGui::Separator();
+
+		if (ImGui::BeginTable("GPUScopes", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+		{
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("GPU ms", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableHeadersRow();
+
+			for (const auto& result : m_Results)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::SetCursorPosX(ImGui::GetCursorPosX() + result.Depth * ImGui::GetStyle().IndentSpacing);
+				ImGui::TextUnformatted(result.Name.c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", result.Milliseconds);
+			}
+
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
+	}
+
+}
\ No newline at end of file
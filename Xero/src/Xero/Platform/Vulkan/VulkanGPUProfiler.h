@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Vulkan.h"
+
+#include <mutex>
+
+namespace Xero {
+
+	struct GPUProfilerScopeResult
+	{
+		std::string Name;
+		uint32_t Depth = 0; // Nesting within the command buffer the scope was recorded in
+		float Milliseconds = 0.0f;
+	};
+
+	// Timestamp queries around named command buffer regions. Every frame in flight owns a query pool,
+	// it is read back when its frame slot comes round again, so results are FramesInFlight frames old
+	// and reading them never stalls
+	class VulkanGPUProfiler
+	{
+	public:
+		VulkanGPUProfiler(uint32_t framesInFlight, uint32_t maxScopesPerFrame = 256);
+		~VulkanGPUProfiler();
+
+		// The GPU must be done with the frame slot, i.e. after the swapchain has waited for it
+		void BeginFrame(uint32_t frameIndex, uint64_t frameNumber);
+
+		// Safe from recording threads. Returns an index for EndScope, UINT32_MAX when out of queries or unsupported
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const std::string& name);
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scopeIndex);
+
+		// Scopes in begin order from the most recently read back frame
+		const std::vector<GPUProfilerScopeResult>& GetResults() const { return m_Results; }
+		uint64_t GetResultsFrameNumber() const { return m_ResultsFrameNumber; }
+		float GetScopeTime(const std::string& name) const;
+
+		bool IsSupported() const { return m_Supported; }
+
+		void OnImGuiRender();
+
+	private:
+		struct ScopeInfo
+		{
+			std::string Name;
+			uint32_t Depth = 0;
+		};
+
+		struct FrameQueries
+		{
+			VkQueryPool QueryPool = VK_NULL_HANDLE;
+			std::vector<ScopeInfo> Scopes; // Scope i owns queries 2i and 2i + 1
+			std::unordered_map<VkCommandBuffer, uint32_t> OpenScopeCount;
+			uint64_t FrameNumber = 0;
+		};
+
+		void ReadResults(FrameQueries& frame);
+
+	private:
+		std::vector<FrameQueries> m_Frames;
+		uint32_t m_CurrentFrameIndex = 0;
+		uint32_t m_MaxScopesPerFrame = 0;
+
+		bool m_Supported = false;
+		float m_TimestampPeriod = 1.0f; // Nanoseconds per tick
+		uint64_t m_TimestampMask = ~0ull;
+
+		std::vector<GPUProfilerScopeResult> m_Results;
+		uint64_t m_ResultsFrameNumber = 0;
+
+		std::mutex m_Mutex;
+	};
+
+	// Brackets the commands recorded during its lifetime
+	class VulkanGPUProfilerScope
+	{
+	public:
+		VulkanGPUProfilerScope(VulkanGPUProfiler& profiler, VkCommandBuffer commandBuffer, const std::string& name)
+			: m_Profiler(profiler), m_CommandBuffer(commandBuffer), m_ScopeIndex(profiler.BeginScope(commandBuffer, name)) {}
+		~VulkanGPUProfilerScope() { m_Profiler.EndScope(m_CommandBuffer, m_ScopeIndex); }
+
+	private:
+		VulkanGPUProfiler& m_Profiler;
+		VkCommandBuffer m_CommandBuffer;
+		uint32_t m_ScopeIndex;
+	};
+
+}
\ No newline at end of file
@@ -10,12 +10,11 @@
 #include "Xero/Core/Application.h"
 #include "Xero/Platform/Vulkan/VulkanContext.h"
 #include "Xero/Platform/Vulkan/VulkanSwapchain.h"
+#include "Xero/Platform/Vulkan/VulkanRenderer.h"
 #include "Xero/Renderer/Renderer.h"
 
 namespace Xero {
 
-	static std::vector<VkCommandBuffer> s_ImGuiCommandBuffers;
-
 	VulkanImGuiLayer::VulkanImGuiLayer()
 	{
 
@@ -45,6 +44,10 @@ namespace Xero {
 		//io.ConfigViewportsNoAutoMerge = true;
 		//io.ConfigViewportsNoTaskBarIcon = true;
 
+		// Platform windows need the GLFW backend, a headless window has nothing behind it
+		if (Renderer::GetConfig().Headless)
+			io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+
 		//io.Fonts->AddFontFromFileTTF("Resources/Fonts/opensans/OpenSans-Bold.ttf", 18.0f);
 		//io.Fonts->AddFontFromFileTTF("Resources/Fonts/opensans/OpenSans-Regular.ttf", 24.0f);
 		//io.FontDefault = io.Fonts->AddFontFromFileTTF("Resources/Fonts/opensans/OpenSans-Regular.ttf", 18.0f);
@@ -95,14 +98,15 @@ namespace Xero {
 		VK_CHECK_RESULT(vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptorPool));
 
 		// Setup Platform/Renderer bindings
-		ImGui_ImplGlfw_InitForVulkan(window, true);
+		if (!Renderer::GetConfig().Headless)
+			ImGui_ImplGlfw_InitForVulkan(window, true);
 		ImGui_ImplVulkan_InitInfo init_info = {};
 		init_info.Instance = VulkanContext::GetInstance();
 		init_info.PhysicalDevice = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetVulkanPhysicalDevice();
 		init_info.Device = device;
 		init_info.QueueFamily = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
 		init_info.Queue = VulkanContext::GetCurrentDevice()->GetGraphicsQueue();
-		init_info.PipelineCache = nullptr;
+		init_info.PipelineCache = vulkanContext->GetPipelineCache();
 		init_info.DescriptorPool = descriptorPool;
 		init_info.Allocator = nullptr;
 		init_info.MinImageCount = 2;
@@ -128,20 +132,12 @@ namespace Xero {
 
 		// Upload Fonts
 		{
-			// Use any command queue
-
-			VkCommandBuffer commandBuffer = vulkanContext->GetCurrentDevice()->GetCommandBuffer(true);
-			ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
-			vulkanContext->GetCurrentDevice()->FlushCommandBuffer(commandBuffer);
-
-			VK_CHECK_RESULT(vkDeviceWaitIdle(device));
-			ImGui_ImplVulkan_DestroyFontUploadObjects();
+			// Goes out with the first frame, submission order on the graphics queue puts it ahead of any ImGui draw
+			VulkanRenderer::GetImmediateSubmitter().SubmitAsync([](VkCommandBuffer commandBuffer)
+			{
+				ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+			}, []() { ImGui_ImplVulkan_DestroyFontUploadObjects(); });
 		}
-
-		uint32_t framesInFlight = Renderer::GetConfig().FramesInFlight;
-		s_ImGuiCommandBuffers.resize(framesInFlight);
-		for (uint32_t i = 0; i < framesInFlight; i++)
-			s_ImGuiCommandBuffers[i] = VulkanContext::GetCurrentDevice()->CreateSecondaryCommandBuffer();
 	}
 
 	void VulkanImGuiLayer::OnDetach()
@@ -152,7 +148,18 @@ namespace Xero {
 	void VulkanImGuiLayer::Begin()
 	{
 		ImGui_ImplVulkan_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
+		if (Renderer::GetConfig().Headless)
+		{
+			// No platform backend, the display and clock are driven by hand. A fixed step keeps captures reproducible
+			VulkanSwapchain& swapChain = Application::Get().GetWindow().GetSwapchain();
+			ImGuiIO& io = ImGui::GetIO();
+			io.DisplaySize = ImVec2((float)swapChain.GetWidth(), (float)swapChain.GetHeight());
+			io.DeltaTime = 1.0f / 60.0f;
+		}
+		else
+		{
+			ImGui_ImplGlfw_NewFrame();
+		}
 		ImGui::NewFrame();
 	}
 
@@ -169,7 +176,8 @@ namespace Xero {
 		uint32_t width = swapChain.GetWidth();
 		uint32_t height = swapChain.GetHeight();
 
-		uint32_t commandBufferIndex = swapChain.GetCurrentBufferIndex();
+		// Comes from the frame context, so it is never re-recorded while the GPU still reads it
+		VkCommandBuffer imguiCommandBuffer = VulkanRenderer::GetCurrentFrameContext().AllocateCommandBuffer(true);
 
 		VkCommandBufferBeginInfo drawCmdBufInfo = {};
 		drawCmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -179,6 +187,9 @@ namespace Xero {
 		VkCommandBuffer drawCommandBuffer = swapChain.GetCurrentDrawCommandBuffer();
 		VK_CHECK_RESULT(vkBeginCommandBuffer(drawCommandBuffer, &drawCmdBufInfo));
 
+		VulkanGPUProfiler& profiler = VulkanRenderer::GetGPUProfiler();
+		uint32_t frameScope = profiler.BeginScope(drawCommandBuffer, "Frame");
+
 		VkRenderPassBeginInfo renderPassBeginInfo = {};
 		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		renderPassBeginInfo.pNext = nullptr;
@@ -203,7 +214,7 @@ namespace Xero {
 		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
 		cmdBufInfo.pInheritanceInfo = &inheritanceInfo;
 
-		VK_CHECK_RESULT(vkBeginCommandBuffer(s_ImGuiCommandBuffers[commandBufferIndex], &cmdBufInfo));
+		VK_CHECK_RESULT(vkBeginCommandBuffer(imguiCommandBuffer, &cmdBufInfo));
 
 		VkViewport viewport = {};
 		viewport.x = 0.0f;
@@ -212,27 +223,33 @@ namespace Xero {
 		viewport.width = (float)width;
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
-		vkCmdSetViewport(s_ImGuiCommandBuffers[commandBufferIndex], 0, 1, &viewport);
+		vkCmdSetViewport(imguiCommandBuffer, 0, 1, &viewport);
 
 		VkRect2D scissor = {};
 		scissor.extent.width = width;
 		scissor.extent.height = height;
 		scissor.offset.x = 0;
 		scissor.offset.y = 0;
-		vkCmdSetScissor(s_ImGuiCommandBuffers[commandBufferIndex], 0, 1, &scissor);
+		vkCmdSetScissor(imguiCommandBuffer, 0, 1, &scissor);
 
-		ImDrawData* main_draw_data = ImGui::GetDrawData();
-		ImGui_ImplVulkan_RenderDrawData(main_draw_data, s_ImGuiCommandBuffers[commandBufferIndex]);
+		// The primary may only execute secondaries inside this render pass, so the scope is written in here
+		{
+			VulkanGPUProfilerScope imguiScope(profiler, imguiCommandBuffer, "ImGui");
+			ImDrawData* main_draw_data = ImGui::GetDrawData();
+			ImGui_ImplVulkan_RenderDrawData(main_draw_data, imguiCommandBuffer);
+		}
 
-		VK_CHECK_RESULT(vkEndCommandBuffer(s_ImGuiCommandBuffers[commandBufferIndex]));
+		VK_CHECK_RESULT(vkEndCommandBuffer(imguiCommandBuffer));
 
 		std::vector<VkCommandBuffer> commandBuffers;
-		commandBuffers.push_back(s_ImGuiCommandBuffers[commandBufferIndex]);
+		commandBuffers.push_back(imguiCommandBuffer);
 
 		vkCmdExecuteCommands(drawCommandBuffer, uint32_t(commandBuffers.size()), commandBuffers.data());
 
 		vkCmdEndRenderPass(drawCommandBuffer);
 
+		profiler.EndScope(drawCommandBuffer, frameScope);
+
 		VK_CHECK_RESULT(vkEndCommandBuffer(drawCommandBuffer));
 
 		ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -246,7 +263,7 @@ namespace Xero {
 
 	void VulkanImGuiLayer::OnImGuiRender()
 	{
-
+		VulkanRenderer::GetGPUProfiler().OnImGuiRender();
 	}
 
 }
\ No newline at end of file
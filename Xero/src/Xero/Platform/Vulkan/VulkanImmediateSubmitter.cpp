@@ -0,0 +1,162 @@
+#include "xopch.h"
+#include "VulkanImmediateSubmitter.h"
+
+#include "VulkanContext.h"
+
+namespace Xero {
+
+	VulkanImmediateSubmitter::VulkanImmediateSubmitter()
+	{
+		auto device = VulkanContext::GetCurrentDevice();
+
+		VkCommandPoolCreateInfo cmdPoolInfo{};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.queueFamilyIndex = device->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		VK_CHECK_RESULT(vkCreateCommandPool(device->GetVulkanDevice(), &cmdPoolInfo, nullptr, &m_CommandPool));
+	}
+
+	VulkanImmediateSubmitter::~VulkanImmediateSubmitter()
+	{
+		// Owned by the renderer, which waits for the device before tearing down
+		Update();
+
+		// Command buffers go with the pool
+		vkDestroyCommandPool(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), m_CommandPool, nullptr);
+	}
+
+	VulkanSubmitHandle VulkanImmediateSubmitter::SubmitAsync(const RecordFunc& func, std::function<void()>&& onComplete)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		Batch& batch = GetOpenBatch();
+		func(batch.CommandBuffer);
+		batch.SubmissionCount++;
+
+		if (onComplete)
+			batch.CompletionCallbacks.push_back(std::move(onComplete));
+
+		return { batch.ID };
+	}
+
+	void VulkanImmediateSubmitter::Submit(const RecordFunc& func)
+	{
+		Wait(SubmitAsync(func));
+	}
+
+	void VulkanImmediateSubmitter::Flush()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		if (!m_OpenBatch)
+			return;
+
+		Batch batch = std::move(*m_OpenBatch);
+		m_OpenBatch.reset();
+
+		VK_CHECK_RESULT(vkEndCommandBuffer(batch.CommandBuffer));
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.CommandBuffer;
+		batch.CompletionValue = VulkanContext::GetCurrentDevice()->Submit(VulkanQueueType::Graphics, submitInfo);
+
+		if (batch.SubmissionCount > 1)
+			XO_CORE_TRACE("VulkanImmediateSubmitter: coalesced {0} submissions into batch {1}", batch.SubmissionCount, batch.ID);
+
+		m_InFlightBatches.push_back(std::move(batch));
+	}
+
+	void VulkanImmediateSubmitter::Wait(VulkanSubmitHandle handle)
+	{
+		if (IsComplete(handle))
+			return;
+
+		Flush();
+
+		// Batches complete in submission order, waiting for the newest requested one covers the rest
+		uint64_t completionValue = 0;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			for (const Batch& batch : m_InFlightBatches)
+			{
+				if (batch.ID <= handle.BatchID)
+					completionValue = batch.CompletionValue;
+			}
+		}
+
+		if (completionValue)
+			VulkanContext::GetCurrentDevice()->GetTimeline(VulkanQueueType::Graphics).Wait(completionValue);
+
+		Update();
+	}
+
+	void VulkanImmediateSubmitter::Update()
+	{
+		std::vector<std::function<void()>> callbacks;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+
+			// One query for the whole loop rather than one per batch
+			uint64_t completedValue = VulkanContext::GetCurrentDevice()->GetTimeline(VulkanQueueType::Graphics).GetCompletedValue();
+			while (!m_InFlightBatches.empty())
+			{
+				Batch& batch = m_InFlightBatches.front();
+				if (batch.CompletionValue > completedValue)
+					break;
+
+				m_CompletedBatchID = batch.ID;
+
+				for (auto& callback : batch.CompletionCallbacks)
+					callbacks.push_back(std::move(callback));
+				batch.CompletionCallbacks.clear();
+				batch.SubmissionCount = 0;
+
+				m_FreeBatches.push_back(std::move(batch));
+				m_InFlightBatches.pop_front();
+			}
+		}
+
+		// Outside the lock, a callback may well submit more work
+		for (auto& callback : callbacks)
+			callback();
+	}
+
+	VulkanImmediateSubmitter::Batch& VulkanImmediateSubmitter::GetOpenBatch()
+	{
+		if (m_OpenBatch)
+			return *m_OpenBatch;
+
+		if (m_FreeBatches.empty())
+		{
+			VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+			Batch batch;
+
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = m_CommandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocateInfo, &batch.CommandBuffer));
+
+			m_OpenBatch = std::move(batch);
+		}
+		else
+		{
+			m_OpenBatch = std::move(m_FreeBatches.back());
+			m_FreeBatches.pop_back();
+		}
+
+		Batch& batch = *m_OpenBatch;
+		batch.ID = m_NextBatchID++;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK_RESULT(vkBeginCommandBuffer(batch.CommandBuffer, &beginInfo));
+
+		return batch;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Vulkan.h"
+
+#include <mutex>
+#include <deque>
+#include <optional>
+#include <atomic>
+
+namespace Xero {
+
+	// Identifies the batch a submission was recorded into, an empty handle is always complete
+	struct VulkanSubmitHandle
+	{
+		uint64_t BatchID = 0;
+	};
+
+	// One-shot graphics queue work (layout transitions, small copies, font uploads). Submissions are recorded
+	// into a shared open batch and go out together on Flush. Command buffers are recycled, completion is
+	// tracked on the graphics timeline
+	class VulkanImmediateSubmitter
+	{
+	public:
+		using RecordFunc = std::function<void(VkCommandBuffer)>;
+
+	public:
+		VulkanImmediateSubmitter();
+		~VulkanImmediateSubmitter();
+
+		// Records into the open batch. onComplete runs from Update once the GPU has finished the batch
+		VulkanSubmitHandle SubmitAsync(const RecordFunc& func, std::function<void()>&& onComplete = nullptr);
+		// Blocks on this batch's timeline value only, never on the whole device
+		void Submit(const RecordFunc& func);
+
+		void Flush();
+		void Wait(VulkanSubmitHandle handle);
+
+		// Recycles batches whose timeline value has been reached and runs their completion callbacks
+		void Update();
+
+		bool IsComplete(VulkanSubmitHandle handle) const { return handle.BatchID <= m_CompletedBatchID; }
+
+	private:
+		struct Batch
+		{
+			uint64_t ID = 0;
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			uint64_t CompletionValue = 0; // Graphics timeline
+			uint32_t SubmissionCount = 0;
+			std::vector<std::function<void()>> CompletionCallbacks;
+		};
+
+		Batch& GetOpenBatch();
+
+	private:
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+		std::optional<Batch> m_OpenBatch;
+		std::deque<Batch> m_InFlightBatches; // Submission order, retired from the front
+		std::vector<Batch> m_FreeBatches;
+
+		uint64_t m_NextBatchID = 1;
+		std::atomic<uint64_t> m_CompletedBatchID = 0;
+
+		std::mutex m_Mutex;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "xopch.h"
+#include "VulkanPipeline.h"
+
+#include "VulkanContext.h"
+#include "VulkanRenderer.h"
+
+namespace Xero {
+
+	namespace Utils {
+
+		static void HashCombine(size_t& seed, size_t value)
+		{
+			seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Pipeline
+	//////////////////////////////////////////////////////////////////////////
+
+	VulkanPipeline::VulkanPipeline(const VulkanPipelineSpecification& specification)
+		: m_Specification(specification)
+	{
+		XO_CORE_ASSERT(specification.Shader);
+		XO_CORE_ASSERT(specification.RenderPass);
+		Invalidate();
+	}
+
+	void VulkanPipeline::Invalidate()
+	{
+		const Ref<VulkanShader>& shader = m_Specification.Shader;
+
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		for (const auto& range : shader->GetPushConstantRanges())
+			pushConstantRanges.push_back({ (VkShaderStageFlags)range.ShaderStage, range.Offset, range.Size });
+
+		VulkanPipelineStateCache& cache = VulkanRenderer::GetPipelineStateCache();
+		m_PipelineLayout = cache.GetOrCreatePipelineLayout(shader->GetAllDescriptorSetLayouts(), pushConstantRanges);
+		m_Pipeline = cache.GetOrCreatePipeline(m_Specification, m_PipelineLayout);
+		m_ShaderContentHash = shader->GetContentHash();
+	}
+
+	VkPipeline VulkanPipeline::GetVulkanPipeline()
+	{
+		if (m_ShaderContentHash != m_Specification.Shader->GetContentHash())
+			Invalidate();
+
+		return m_Pipeline;
+	}
+
+	VkPipelineLayout VulkanPipeline::GetVulkanPipelineLayout()
+	{
+		if (m_ShaderContentHash != m_Specification.Shader->GetContentHash())
+			Invalidate();
+
+		return m_PipelineLayout;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Pipeline State Cache
+	//////////////////////////////////////////////////////////////////////////
+
+	VulkanPipelineStateCache::VulkanPipelineStateCache()
+		: m_Device(VulkanContext::GetCurrentDevice()->GetVulkanDevice()), m_VulkanPipelineCache(VulkanContext::Get()->GetPipelineCache())
+	{
+	}
+
+	VulkanPipelineStateCache::~VulkanPipelineStateCache()
+	{
+		Destroy();
+	}
+
+	VkPipelineLayout VulkanPipelineStateCache::GetOrCreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+	{
+		// Set layouts are deduplicated already, so comparing handles is enough
+		PipelineLayoutKey key{ setLayouts, pushConstantRanges };
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		auto it = m_PipelineLayouts.find(key);
+		if (it != m_PipelineLayouts.end())
+			return it->second;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount = (uint32_t)setLayouts.size();
+		pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)pushConstantRanges.size();
+		pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
+
+		VkPipelineLayout layout;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &layout));
+
+		m_PipelineLayouts[std::move(key)] = layout;
+		return layout;
+	}
+
+	VkPipeline VulkanPipelineStateCache::GetOrCreatePipeline(const VulkanPipelineSpecification& specification, VkPipelineLayout layout)
+	{
+		PipelineKey key;
+		key.ShaderHash = specification.Shader->GetHash();
+		key.ShaderContentHash = specification.Shader->GetContentHash();
+		key.Layout = layout;
+		key.RenderPass = specification.RenderPass;
+		key.Subpass = specification.Subpass;
+		key.VertexStride = specification.VertexLayout.Stride;
+		key.VertexAttributes = specification.VertexLayout.Attributes;
+		key.Topology = specification.Topology;
+		key.PolygonMode = specification.PolygonMode;
+		key.CullMode = specification.CullMode;
+		key.FrontFace = specification.FrontFace;
+		key.LineWidth = specification.LineWidth;
+		key.DepthTest = specification.DepthTest;
+		key.DepthWrite = specification.DepthWrite;
+		key.DepthCompareOp = specification.DepthCompareOp;
+		key.BlendEnable = specification.BlendEnable;
+		key.ColorAttachmentCount = specification.ColorAttachmentCount;
+		key.Samples = specification.Samples;
+
+		// Held while compiling too, two threads asking for the same state must not both create it
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		auto it = m_Pipelines.find(key);
+		if (it != m_Pipelines.end())
+			return it->second;
+
+		VkPipeline pipeline = CreatePipeline(specification, layout);
+		m_Pipelines[std::move(key)] = pipeline;
+		return pipeline;
+	}
+
+	VkPipeline VulkanPipelineStateCache::GetOrCreateComputePipeline(const Ref<VulkanShader>& shader, VkPipelineLayout layout, const std::string& debugName)
+	{
+		ComputePipelineKey key{ shader->GetHash(), shader->GetContentHash(), layout };
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		auto it = m_ComputePipelines.find(key);
+		if (it != m_ComputePipelines.end())
+			return it->second;
+
+		m_FrameCompileCount++;
+		m_TotalCompileCount++;
+		XO_CORE_TRACE("Compiling compute pipeline {0} ({1} this frame)", debugName, m_FrameCompileCount);
+
+		const auto& shaderStages = shader->GetPipelineShaderStageCreateInfos();
+		XO_CORE_ASSERT(shaderStages.size() == 1 && shaderStages[0].stage == VK_SHADER_STAGE_COMPUTE_BIT, "Compute pipelines take a single compute stage");
+
+		VkComputePipelineCreateInfo pipelineCreateInfo{};
+		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineCreateInfo.layout = layout;
+		pipelineCreateInfo.stage = shaderStages[0];
+
+		VkPipeline pipeline;
+		VK_CHECK_RESULT(vkCreateComputePipelines(m_Device, m_VulkanPipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline));
+
+		m_ComputePipelines[key] = pipeline;
+		return pipeline;
+	}
+
+	VkPipeline VulkanPipelineStateCache::CreatePipeline(const VulkanPipelineSpecification& specification, VkPipelineLayout layout)
+	{
+		m_FrameCompileCount++;
+		m_TotalCompileCount++;
+		XO_CORE_TRACE("Compiling pipeline {0} ({1} this frame)", specification.DebugName, m_FrameCompileCount);
+
+		// Vertex Input
+		VkVertexInputBindingDescription vertexInputBinding{};
+		vertexInputBinding.binding = 0;
+		vertexInputBinding.stride = specification.VertexLayout.Stride;
+		vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+		for (const auto& attribute : specification.VertexLayout.Attributes)
+			vertexInputAttributes.push_back({ attribute.Location, 0, attribute.Format, attribute.Offset });
+
+		VkPipelineVertexInputStateCreateInfo vertexInputState{};
+		vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputState.vertexBindingDescriptionCount = specification.VertexLayout.Stride ? 1 : 0;
+		vertexInputState.pVertexBindingDescriptions = &vertexInputBinding;
+		vertexInputState.vertexAttributeDescriptionCount = (uint32_t)vertexInputAttributes.size();
+		vertexInputState.pVertexAttributeDescriptions = vertexInputAttributes.data();
+
+		// Input Assembly
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{};
+		inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssemblyState.topology = specification.Topology;
+
+		// Rasterization
+		VkPipelineRasterizationStateCreateInfo rasterizationState{};
+		rasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizationState.polygonMode = specification.PolygonMode;
+		rasterizationState.cullMode = specification.CullMode;
+		rasterizationState.frontFace = specification.FrontFace;
+		rasterizationState.lineWidth = specification.LineWidth;
+
+		// Color Blend
+		std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates(specification.ColorAttachmentCount);
+		for (auto& blendAttachmentState : blendAttachmentStates)
+		{
+			blendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			blendAttachmentState.blendEnable = specification.BlendEnable;
+			blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+		}
+
+		VkPipelineColorBlendStateCreateInfo colorBlendState{};
+		colorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlendState.attachmentCount = (uint32_t)blendAttachmentStates.size();
+		colorBlendState.pAttachments = blendAttachmentStates.data();
+
+		// Viewport and scissor are set when recording
+		VkPipelineViewportStateCreateInfo viewportState{};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = (uint32_t)dynamicStateEnables.size();
+		dynamicState.pDynamicStates = dynamicStateEnables.data();
+
+		// Depth and Stencil
+		VkPipelineDepthStencilStateCreateInfo depthStencilState{};
+		depthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilState.depthTestEnable = specification.DepthTest;
+		depthStencilState.depthWriteEnable = specification.DepthWrite;
+		depthStencilState.depthCompareOp = specification.DepthCompareOp;
+		depthStencilState.back.failOp = VK_STENCIL_OP_KEEP;
+		depthStencilState.back.passOp = VK_STENCIL_OP_KEEP;
+		depthStencilState.back.compareOp = VK_COMPARE_OP_ALWAYS;
+		depthStencilState.front = depthStencilState.back;
+
+		// Multisampling
+		VkPipelineMultisampleStateCreateInfo multisampleState{};
+		multisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampleState.rasterizationSamples = specification.Samples;
+
+		const auto& shaderStages = specification.Shader->GetPipelineShaderStageCreateInfos();
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineCreateInfo.layout = layout;
+		pipelineCreateInfo.renderPass = specification.RenderPass;
+		pipelineCreateInfo.subpass = specification.Subpass;
+		pipelineCreateInfo.stageCount = (uint32_t)shaderStages.size();
+		pipelineCreateInfo.pStages = shaderStages.data();
+		pipelineCreateInfo.pVertexInputState = &vertexInputState;
+		pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+		pipelineCreateInfo.pRasterizationState = &rasterizationState;
+		pipelineCreateInfo.pColorBlendState = &colorBlendState;
+		pipelineCreateInfo.pMultisampleState = &multisampleState;
+		pipelineCreateInfo.pViewportState = &viewportState;
+		pipelineCreateInfo.pDepthStencilState = &depthStencilState;
+		pipelineCreateInfo.pDynamicState = &dynamicState;
+
+		VkPipeline pipeline;
+		VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_Device, m_VulkanPipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline));
+		return pipeline;
+	}
+
+	void VulkanPipelineStateCache::EvictShader(size_t shaderHash, uint32_t shaderContentHash)
+	{
+		std::vector<VkPipeline> stalePipelines;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			for (auto it = m_Pipelines.begin(); it != m_Pipelines.end(); )
+			{
+				if (it->first.ShaderHash == shaderHash && it->first.ShaderContentHash == shaderContentHash)
+				{
+					stalePipelines.push_back(it->second);
+					it = m_Pipelines.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+
+			for (auto it = m_ComputePipelines.begin(); it != m_ComputePipelines.end(); )
+			{
+				if (it->first.ShaderHash == shaderHash && it->first.ShaderContentHash == shaderContentHash)
+				{
+					stalePipelines.push_back(it->second);
+					it = m_ComputePipelines.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+		}
+
+		if (stalePipelines.empty())
+			return;
+
+		XO_CORE_TRACE("VulkanPipelineStateCache: evicting {0} stale pipelines", stalePipelines.size());
+
+		VulkanRenderer::SubmitResourceFree([device = m_Device, stalePipelines]()
+		{
+			for (VkPipeline pipeline : stalePipelines)
+				vkDestroyPipeline(device, pipeline, nullptr);
+		});
+	}
+
+	void VulkanPipelineStateCache::Destroy()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		if (m_Pipelines.empty() && m_ComputePipelines.empty() && m_PipelineLayouts.empty())
+			return;
+
+		XO_CORE_TRACE("VulkanPipelineStateCache: destroying {0} pipelines ({1} compiled in total)", m_Pipelines.size() + m_ComputePipelines.size(), m_TotalCompileCount);
+
+		for (auto& [key, pipeline] : m_Pipelines)
+			vkDestroyPipeline(m_Device, pipeline, nullptr);
+		for (auto& [key, pipeline] : m_ComputePipelines)
+			vkDestroyPipeline(m_Device, pipeline, nullptr);
+		for (auto& [key, layout] : m_PipelineLayouts)
+			vkDestroyPipelineLayout(m_Device, layout, nullptr);
+
+		m_Pipelines.clear();
+		m_ComputePipelines.clear();
+		m_PipelineLayouts.clear();
+	}
+
+	bool VulkanPipelineStateCache::PipelineLayoutKey::operator==(const PipelineLayoutKey& other) const
+	{
+		if (SetLayouts != other.SetLayouts || PushConstantRanges.size() != other.PushConstantRanges.size())
+			return false;
+
+		for (size_t i = 0; i < PushConstantRanges.size(); i++)
+		{
+			const auto& a = PushConstantRanges[i];
+			const auto& b = other.PushConstantRanges[i];
+			if (a.stageFlags != b.stageFlags || a.offset != b.offset || a.size != b.size)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool VulkanPipelineStateCache::PipelineKey::operator==(const PipelineKey& other) const
+	{
+		if (VertexAttributes.size() != other.VertexAttributes.size())
+			return false;
+
+		for (size_t i = 0; i < VertexAttributes.size(); i++)
+		{
+			const auto& a = VertexAttributes[i];
+			const auto& b = other.VertexAttributes[i];
+			if (a.Location != b.Location || a.Format != b.Format || a.Offset != b.Offset)
+				return false;
+		}
+
+		return ShaderHash == other.ShaderHash && ShaderContentHash == other.ShaderContentHash && Layout == other.Layout
+			&& RenderPass == other.RenderPass && Subpass == other.Subpass && VertexStride == other.VertexStride
+			&& Topology == other.Topology && PolygonMode == other.PolygonMode && CullMode == other.CullMode
+			&& FrontFace == other.FrontFace && LineWidth == other.LineWidth && DepthTest == other.DepthTest
+			&& DepthWrite == other.DepthWrite && DepthCompareOp == other.DepthCompareOp && BlendEnable == other.BlendEnable
+			&& ColorAttachmentCount == other.ColorAttachmentCount && Samples == other.Samples;
+	}
+
+	bool VulkanPipelineStateCache::ComputePipelineKey::operator==(const ComputePipelineKey& other) const
+	{
+		return ShaderHash == other.ShaderHash && ShaderContentHash == other.ShaderContentHash && Layout == other.Layout;
+	}
+
+	size_t VulkanPipelineStateCache::KeyHasher::operator()(const PipelineLayoutKey& key) const
+	{
+		size_t result = 0;
+		for (VkDescriptorSetLayout setLayout : key.SetLayouts)
+			Utils::HashCombine(result, std::hash<void*>{}((void*)setLayout));
+		for (const auto& range : key.PushConstantRanges)
+			Utils::HashCombine(result, ((size_t)range.stageFlags << 32) | ((size_t)range.offset << 16) | range.size);
+
+		return result;
+	}
+
+	size_t VulkanPipelineStateCache::KeyHasher::operator()(const PipelineKey& key) const
+	{
+		size_t result = key.ShaderHash;
+		Utils::HashCombine(result, key.ShaderContentHash);
+		Utils::HashCombine(result, std::hash<void*>{}((void*)key.Layout));
+		Utils::HashCombine(result, std::hash<void*>{}((void*)key.RenderPass));
+		Utils::HashCombine(result, ((size_t)key.Subpass << 32) | key.VertexStride);
+		for (const auto& attribute : key.VertexAttributes)
+			Utils::HashCombine(result, ((size_t)attribute.Location << 48) | ((size_t)attribute.Format << 24) | attribute.Offset);
+
+		Utils::HashCombine(result, ((size_t)key.Topology << 32) | ((size_t)key.PolygonMode << 16) | key.CullMode);
+		Utils::HashCombine(result, ((size_t)key.FrontFace << 32) | std::hash<float>{}(key.LineWidth));
+		Utils::HashCombine(result, ((size_t)key.DepthTest << 1) | (size_t)key.DepthWrite | ((size_t)key.BlendEnable << 2) | ((size_t)key.DepthCompareOp << 8));
+		Utils::HashCombine(result, ((size_t)key.ColorAttachmentCount << 32) | key.Samples);
+
+		return result;
+	}
+
+	size_t VulkanPipelineStateCache::KeyHasher::operator()(const ComputePipelineKey& key) const
+	{
+		size_t result = key.ShaderHash;
+		Utils::HashCombine(result, key.ShaderContentHash);
+		Utils::HashCombine(result, std::hash<void*>{}((void*)key.Layout));
+		return result;
+	}
+
+}
\ No newline at end of file
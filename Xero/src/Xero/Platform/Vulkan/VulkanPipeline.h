@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanShader.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace Xero {
+
+	struct VulkanVertexAttribute
+	{
+		uint32_t Location = 0;
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint32_t Offset = 0;
+	};
+
+	struct VulkanVertexLayout
+	{
+		uint32_t Stride = 0;
+		std::vector<VulkanVertexAttribute> Attributes;
+	};
+
+	struct VulkanPipelineSpecification
+	{
+		Ref<VulkanShader> Shader;
+		VkRenderPass RenderPass = VK_NULL_HANDLE;
+		uint32_t Subpass = 0;
+		VulkanVertexLayout VertexLayout;
+
+		// Fixed function state
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkPolygonMode PolygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags CullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		float LineWidth = 1.0f;
+		bool DepthTest = true;
+		bool DepthWrite = true;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		bool BlendEnable = false;
+		uint32_t ColorAttachmentCount = 1;
+		VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+		std::string DebugName;
+	};
+
+	// Graphics pipeline resolved through the renderer's pipeline state cache, so equal
+	// specifications share one VkPipeline. Re-resolves lazily after its shader is hot reloaded
+	class VulkanPipeline : public RefCounted
+	{
+	public:
+		VulkanPipeline(const VulkanPipelineSpecification& specification);
+		virtual ~VulkanPipeline() = default;
+
+		void Invalidate();
+
+		VkPipeline GetVulkanPipeline();
+		VkPipelineLayout GetVulkanPipelineLayout();
+
+		VulkanPipelineSpecification& GetSpecification() { return m_Specification; }
+		const VulkanPipelineSpecification& GetSpecification() const { return m_Specification; }
+
+	private:
+		VulkanPipelineSpecification m_Specification;
+
+		VkPipeline m_Pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		uint32_t m_ShaderContentHash = 0;
+	};
+
+	// Owns every pipeline and pipeline layout, keyed on the full state that goes into creating them.
+	// Identical requests return the existing handle without a driver call. Safe from any thread
+	class VulkanPipelineStateCache
+	{
+	public:
+		VulkanPipelineStateCache();
+		~VulkanPipelineStateCache();
+
+		VkPipelineLayout GetOrCreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
+		VkPipeline GetOrCreatePipeline(const VulkanPipelineSpecification& specification, VkPipelineLayout layout);
+		VkPipeline GetOrCreateComputePipeline(const Ref<VulkanShader>& shader, VkPipelineLayout layout, const std::string& debugName = "");
+		// Drops the pipelines built from a shader's previous code once it has been reloaded. They are destroyed through
+		// the deletion queue, frames in flight may still use them
+		void EvictShader(size_t shaderHash, uint32_t shaderContentHash);
+		void Destroy();
+
+		void ResetFrameStats() { m_FrameCompileCount = 0; }
+		uint32_t GetFrameCompileCount() const { return m_FrameCompileCount; }
+		uint32_t GetTotalCompileCount() const { return m_TotalCompileCount; }
+		uint32_t GetPipelineCount() const
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			return (uint32_t)(m_Pipelines.size() + m_ComputePipelines.size());
+		}
+
+	private:
+		struct PipelineLayoutKey
+		{
+			std::vector<VkDescriptorSetLayout> SetLayouts;
+			std::vector<VkPushConstantRange> PushConstantRanges;
+
+			bool operator==(const PipelineLayoutKey& other) const;
+		};
+
+		struct PipelineKey
+		{
+			size_t ShaderHash = 0;
+			uint32_t ShaderContentHash = 0;
+			VkPipelineLayout Layout = VK_NULL_HANDLE;
+			VkRenderPass RenderPass = VK_NULL_HANDLE;
+			uint32_t Subpass = 0;
+			uint32_t VertexStride = 0;
+			std::vector<VulkanVertexAttribute> VertexAttributes;
+			VkPrimitiveTopology Topology;
+			VkPolygonMode PolygonMode;
+			VkCullModeFlags CullMode;
+			VkFrontFace FrontFace;
+			float LineWidth;
+			bool DepthTest, DepthWrite;
+			VkCompareOp DepthCompareOp;
+			bool BlendEnable;
+			uint32_t ColorAttachmentCount;
+			VkSampleCountFlagBits Samples;
+
+			bool operator==(const PipelineKey& other) const;
+		};
+
+		struct ComputePipelineKey
+		{
+			size_t ShaderHash = 0;
+			uint32_t ShaderContentHash = 0;
+			VkPipelineLayout Layout = VK_NULL_HANDLE;
+
+			bool operator==(const ComputePipelineKey& other) const;
+		};
+
+		struct KeyHasher
+		{
+			size_t operator()(const PipelineLayoutKey& key) const;
+			size_t operator()(const PipelineKey& key) const;
+			size_t operator()(const ComputePipelineKey& key) const;
+		};
+
+		VkPipeline CreatePipeline(const VulkanPipelineSpecification& specification, VkPipelineLayout layout);
+
+	private:
+		std::unordered_map<PipelineLayoutKey, VkPipelineLayout, KeyHasher> m_PipelineLayouts;
+		std::unordered_map<PipelineKey, VkPipeline, KeyHasher> m_Pipelines;
+		std::unordered_map<ComputePipelineKey, VkPipeline, KeyHasher> m_ComputePipelines;
+
+		std::atomic<uint32_t> m_FrameCompileCount = 0;
+		std::atomic<uint32_t> m_TotalCompileCount = 0;
+
+		// Parallel recording jobs may re-resolve pipelines after a reload, they must not go through the context's Refs
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkPipelineCache m_VulkanPipelineCache = VK_NULL_HANDLE;
+		mutable std::mutex m_Mutex;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "xopch.h"
+#include "VulkanRenderer.h"
+
+#include "VulkanContext.h"
+#include "VulkanDescriptorAllocator.h"
+
+#include "Xero/Core/ThreadPool.h"
+#include "Xero/Renderer/Renderer.h"
+
+namespace Xero {
+
+	struct VulkanRendererData
+	{
+		// First so it is destroyed last, the other members may still defer frees while they are torn down
+		VulkanDeletionQueue DeletionQueue;
+
+		VulkanDescriptorAllocator MaterialDescriptorAllocator{ VulkanContext::GetCurrentDevice()->GetVulkanDevice() };
+		VulkanDescriptorSetLayoutCache DescriptorSetLayoutCache;
+		VulkanPipelineStateCache PipelineStateCache;
+		VulkanUploadScheduler UploadScheduler;
+		VulkanImmediateSubmitter ImmediateSubmitter;
+		Scope<VulkanGPUProfiler> GPUProfiler;
+		Scope<VulkanUniformBufferRing> UniformBufferRing;
+		Scope<VulkanBindlessTable> BindlessTable;
+
+		std::vector<Scope<VulkanFrameContext>> FrameContexts;
+		uint64_t FrameNumber = 0;
+	};
+
+	static VulkanRendererData* s_Data = nullptr;
+
+	void VulkanRenderer::Init()
+	{
+		s_Data = new VulkanRendererData();
+
+		uint32_t framesInFlight = Renderer::GetConfig().FramesInFlight;
+		for (uint32_t i = 0; i < framesInFlight; i++)
+			s_Data->FrameContexts.push_back(CreateScope<VulkanFrameContext>(i));
+
+		s_Data->GPUProfiler = CreateScope<VulkanGPUProfiler>(framesInFlight);
+		s_Data->UniformBufferRing = CreateScope<VulkanUniformBufferRing>(framesInFlight, Renderer::GetConfig().UniformBufferRegionSize);
+
+		if (Renderer::GetConfig().Bindless)
+		{
+			if (VulkanContext::GetCurrentDevice()->IsDescriptorIndexingEnabled())
+				s_Data->BindlessTable = CreateScope<VulkanBindlessTable>();
+			else
+				XO_CORE_WARN("VulkanRenderer: bindless rendering was requested but the device does not support descriptor indexing");
+		}
+	}
+
+	void VulkanRenderer::Shutdown()
+	{
+		// Frame contexts release their resources on destruction, nothing may still be in flight
+		vkDeviceWaitIdle(VulkanContext::GetCurrentDevice()->GetVulkanDevice());
+
+		s_Data->FrameContexts.clear();
+		s_Data->DeletionQueue.FlushAll();
+
+		delete s_Data;
+		s_Data = nullptr;
+	}
+
+	void VulkanRenderer::BeginFrame()
+	{
+		// The swapchain has waited for this frame slot's last submit, so the GPU is done with everything it owns
+		// and with every frame submitted before it
+		uint64_t framesInFlight = s_Data->FrameContexts.size();
+
+		if (s_Data->FrameNumber >= framesInFlight)
+			s_Data->DeletionQueue.Flush(s_Data->FrameNumber - framesInFlight);
+
+		GetCurrentFrameContext().Begin(s_Data->FrameNumber);
+		// Before the immediate flush, the query reset may go out through it
+		s_Data->GPUProfiler->BeginFrame(GetCurrentFrameIndex(), s_Data->FrameNumber);
+		s_Data->UniformBufferRing->Begin(GetCurrentFrameIndex());
+
+		// Uploads recorded since the last frame go out as one batch, finished ones release their staging space
+		s_Data->UploadScheduler.Update();
+		s_Data->UploadScheduler.Flush();
+		s_Data->ImmediateSubmitter.Update();
+		s_Data->ImmediateSubmitter.Flush();
+
+		s_Data->PipelineStateCache.ResetFrameStats();
+	}
+
+	void VulkanRenderer::EndFrame()
+	{
+		s_Data->FrameNumber++;
+	}
+
+	uint32_t VulkanRenderer::GetCurrentFrameIndex()
+	{
+		return (uint32_t)(s_Data->FrameNumber % s_Data->FrameContexts.size());
+	}
+
+	uint64_t VulkanRenderer::GetFrameNumber()
+	{
+		return s_Data->FrameNumber;
+	}
+
+	VulkanFrameContext& VulkanRenderer::GetCurrentFrameContext()
+	{
+		return *s_Data->FrameContexts[GetCurrentFrameIndex()];
+	}
+
+	void VulkanRenderer::SubmitResourceFree(std::function<void()>&& func)
+	{
+		// Before Init and after Shutdown nothing can be in flight
+		if (!s_Data)
+		{
+			func();
+			return;
+		}
+
+		s_Data->DeletionQueue.Push(s_Data->FrameNumber, std::move(func));
+	}
+
+	void VulkanRenderer::FlushResourceFrees()
+	{
+		if (s_Data)
+			s_Data->DeletionQueue.FlushAll();
+	}
+
+	uint32_t VulkanRenderer::GetPendingResourceFreeCount()
+	{
+		return s_Data ? s_Data->DeletionQueue.GetPendingCount() : 0;
+	}
+
+	void VulkanRenderer::RecordParallel(VkCommandBuffer primaryCommandBuffer, const VkCommandBufferInheritanceInfo& inheritanceInfo, uint32_t itemCount,
+		const std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>& recordFunc)
+	{
+		if (itemCount == 0)
+			return;
+
+		// A few ranges per worker so an expensive range does not hold up the others
+		ThreadPool& threadPool = ThreadPool::Get();
+		uint32_t jobCount = std::min(itemCount, std::max(threadPool.GetThreadCount(), 1u) * 2);
+		uint32_t itemsPerJob = (itemCount + jobCount - 1) / jobCount;
+		jobCount = (itemCount + itemsPerJob - 1) / itemsPerJob;
+
+		VulkanFrameContext* frameContext = &GetCurrentFrameContext();
+		std::vector<VkCommandBuffer> commandBuffers(jobCount);
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(jobCount);
+
+		for (uint32_t i = 0; i < jobCount; i++)
+		{
+			jobs.push_back(threadPool.Submit([frameContext, &inheritanceInfo, &recordFunc, &commandBuffers, i, itemsPerJob, itemCount]()
+			{
+				VkCommandBuffer commandBuffer = frameContext->AllocateCommandBuffer(true);
+
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+				beginInfo.pInheritanceInfo = &inheritanceInfo;
+				VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+				uint32_t begin = i * itemsPerJob;
+				recordFunc(commandBuffer, begin, std::min(begin + itemsPerJob, itemCount));
+
+				VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+				commandBuffers[i] = commandBuffer;
+			}));
+		}
+
+		for (auto& job : jobs)
+			job.get();
+
+		vkCmdExecuteCommands(primaryCommandBuffer, jobCount, commandBuffers.data());
+	}
+
+	VkCommandBuffer VulkanRenderer::BeginComputeCommandBuffer()
+	{
+		VkCommandBuffer commandBuffer = GetCurrentFrameContext().AllocateComputeCommandBuffer();
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+		return commandBuffer;
+	}
+
+	void VulkanRenderer::SubmitCompute(VkCommandBuffer commandBuffer, VkPipelineStageFlags graphicsWaitStage)
+	{
+		VulkanFrameContext& frameContext = GetCurrentFrameContext();
+		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		// The graphics submit waits on the compute timeline, so reaching the frame's graphics value implies compute completed
+		uint64_t value = VulkanContext::GetCurrentDevice()->Submit(VulkanQueueType::Compute, submitInfo);
+		frameContext.AddGraphicsTimelineWait({ VulkanQueueType::Compute, value, graphicsWaitStage });
+	}
+
+	VkDescriptorSet VulkanRenderer::RT_AllocateDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes)
+	{
+		return s_Data->MaterialDescriptorAllocator.Allocate(allocInfo, setSizes);
+	}
+
+	VkDescriptorSet VulkanRenderer::RT_AllocateFrameDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes)
+	{
+		return GetCurrentFrameContext().GetDescriptorAllocator().Allocate(allocInfo, setSizes);
+	}
+
+	VulkanDescriptorSetLayoutCache& VulkanRenderer::GetDescriptorSetLayoutCache()
+	{
+		return s_Data->DescriptorSetLayoutCache;
+	}
+
+	VulkanPipelineStateCache& VulkanRenderer::GetPipelineStateCache()
+	{
+		return s_Data->PipelineStateCache;
+	}
+
+	VulkanUploadScheduler& VulkanRenderer::GetUploadScheduler()
+	{
+		return s_Data->UploadScheduler;
+	}
+
+	VulkanImmediateSubmitter& VulkanRenderer::GetImmediateSubmitter()
+	{
+		return s_Data->ImmediateSubmitter;
+	}
+
+	VulkanGPUProfiler& VulkanRenderer::GetGPUProfiler()
+	{
+		return *s_Data->GPUProfiler;
+	}
+
+	VulkanUniformBufferRing& VulkanRenderer::GetUniformBufferRing()
+	{
+		XO_CORE_ASSERT(s_Data, "Shaders with uniform buffers have to be created after VulkanRenderer::Init");
+		return *s_Data->UniformBufferRing;
+	}
+
+	bool VulkanRenderer::IsBindlessEnabled()
+	{
+		return s_Data && s_Data->BindlessTable;
+	}
+
+	VulkanBindlessTable& VulkanRenderer::GetBindlessTable()
+	{
+		XO_CORE_ASSERT(s_Data->BindlessTable, "Bindless rendering is not enabled");
+		return *s_Data->BindlessTable;
+	}
+
+}
\ No newline at end of file
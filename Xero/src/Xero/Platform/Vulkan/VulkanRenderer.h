@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanDescriptorSetLayoutCache.h"
+#include "VulkanPipeline.h"
+#include "VulkanFrameContext.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanUploadScheduler.h"
+#include "VulkanImmediateSubmitter.h"
+#include "VulkanGPUProfiler.h"
+#include "VulkanUniformBufferRing.h"
+#include "VulkanBindlessTable.h"
+
+namespace Xero {
+
+	class VulkanRenderer
+	{
+	public:
+		static void Init();
+		static void Shutdown();
+
+		// Recycles the frame context of the frame that is about to be recorded
+		static void BeginFrame();
+		static void EndFrame();
+
+		// Frame numbers advance monotonically, the frame index is the slot in flight it maps to
+		static uint32_t GetCurrentFrameIndex();
+		static uint64_t GetFrameNumber();
+		static VulkanFrameContext& GetCurrentFrameContext();
+
+		// Defers func until the GPU has finished every frame recorded so far.
+		// Use it for anything a frame in flight may still reference: buffers, images, views, pools, pipelines
+		static void SubmitResourceFree(std::function<void()>&& func);
+		// Runs every deferred free now, the device has to be idle
+		static void FlushResourceFrees();
+		static uint32_t GetPendingResourceFreeCount();
+
+		// Splits itemCount items into contiguous ranges, records each range into its own secondary command buffer on
+		// the thread pool and executes them in order inside primaryCommandBuffer. The render pass must have been begun
+		// with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, recordFunc is called concurrently
+		static void RecordParallel(VkCommandBuffer primaryCommandBuffer, const VkCommandBufferInheritanceInfo& inheritanceInfo, uint32_t itemCount,
+			const std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>& recordFunc);
+
+		// Async compute. The command buffer is already begun; SubmitCompute ends it, submits it on the compute queue
+		// and makes this frame's graphics submit wait on the compute timeline at graphicsWaitStage
+		static VkCommandBuffer BeginComputeCommandBuffer();
+		static void SubmitCompute(VkCommandBuffer commandBuffer, VkPipelineStageFlags graphicsWaitStage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+		// Long-lived descriptor sets for materials, never recycled. setSizes are the descriptors one set of the layout
+		// needs, a set larger than the default pools then gets a pool that fits it
+		static VkDescriptorSet RT_AllocateDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes = {});
+		// Transient descriptor sets, only valid until this frame slot comes round again. Each thread allocates from its
+		// own pools, so RecordParallel jobs may call this
+		static VkDescriptorSet RT_AllocateFrameDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo, const std::vector<VkDescriptorPoolSize>& setSizes = {});
+
+		static VulkanDescriptorSetLayoutCache& GetDescriptorSetLayoutCache();
+		static VulkanPipelineStateCache& GetPipelineStateCache();
+		static VulkanUploadScheduler& GetUploadScheduler();
+		static VulkanImmediateSubmitter& GetImmediateSubmitter();
+		static VulkanGPUProfiler& GetGPUProfiler();
+		// Backs the reflected uniform buffers, see VulkanShader::GetDynamicOffsetCount
+		static VulkanUniformBufferRing& GetUniformBufferRing();
+		// Opt-in through RendererConfig::Bindless, shaders then get the table's layout for VulkanBindlessTable::DescriptorSetIndex
+		static bool IsBindlessEnabled();
+		static VulkanBindlessTable& GetBindlessTable();
+	};
+
+}
\ No newline at end of file
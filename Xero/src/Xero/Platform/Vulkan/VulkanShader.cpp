@@ -2,7 +2,12 @@
 #include "VulkanShader.h"
 
 #include "Xero/Core/Hash.h"
+#include "Xero/Core/ThreadPool.h"
+#include "Xero/Core/Timer.h"
+#include "Xero/Core/FileWatcher.h"
+#include "Xero/Renderer/ShaderCache.h"
 #include "Xero/Platform/Vulkan/VulkanContext.h"
+#include "Xero/Platform/Vulkan/VulkanRenderer.h"
 
 #include <shaderc/shaderc.hpp>
 #include <spirv_cross/spirv_glsl.hpp>
@@ -33,6 +38,36 @@ namespace Xero {
 				std::filesystem::create_directories(cacheDirectory);
 		}
 
+		static ShaderCache& GetShaderCache()
+		{
+			static ShaderCache cache(std::filesystem::path(GetCacheDirectory()) / "ShaderCache.manifest");
+			return cache;
+		}
+
+		static shaderc::CompileOptions GetCompileOptions()
+		{
+			shaderc::CompileOptions options;
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+			options.SetWarningsAsErrors();
+			options.SetGenerateDebugInfo();
+
+			#if OPTIMIZE_COMPILER
+			options.SetOptimizationLevel(shaderc_optimization_level_performance);
+			#endif
+
+			return options;
+		}
+
+		// Describes everything in GetCompileOptions that affects the generated SPIR-V, keep the two in sync
+		static const char* GetCompileOptionsKey()
+		{
+			#if OPTIMIZE_COMPILER
+			return "vulkan1.2;warnings-as-errors;debug-info;optimize-performance";
+			#else
+			return "vulkan1.2;warnings-as-errors;debug-info";
+			#endif
+		}
+
 		static ShaderUniformType SPIRTypeToShaderUniformType(spirv_cross::SPIRType type)
 		{
 			switch (type.basetype)
@@ -58,6 +93,66 @@ namespace Xero {
 			XO_CORE_ASSERT(false, "Unknown type!");
 			return ShaderUniformType::None;
 		}
+
+		static bool IsImageDescriptor(VkDescriptorType type)
+		{
+			return type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		}
+
+		static uint32_t GetBindingPoint(const VulkanShader::UniformBuffer* uniformBuffer) { return uniformBuffer->BindingPoint; }
+		static uint32_t GetBindingPoint(const VulkanShader::StorageBuffer* storageBuffer) { return storageBuffer->BindingPoint; }
+		static uint32_t GetBindingPoint(const VulkanShader::ImageSampler& imageSampler) { return imageSampler.BindingPoint; }
+
+		// Reflection tables are kept sorted by binding, they hold a handful of entries each
+		template<typename T>
+		static typename std::vector<T>::const_iterator FindBinding(const std::vector<T>& table, uint32_t binding)
+		{
+			auto it = std::lower_bound(table.begin(), table.end(), binding, [](const T& entry, uint32_t value) { return GetBindingPoint(entry) < value; });
+			return (it != table.end() && GetBindingPoint(*it) == binding) ? it : table.end();
+		}
+
+		template<typename T>
+		static bool HasBinding(const std::vector<T>& table, uint32_t binding)
+		{
+			return FindBinding(table, binding) != table.end();
+		}
+
+		// Stages reflect the same binding again, the last one wins
+		template<typename T>
+		static void SetBinding(std::vector<T>& table, const T& value)
+		{
+			uint32_t binding = GetBindingPoint(value);
+			auto it = std::lower_bound(table.begin(), table.end(), binding, [](const T& entry, uint32_t b) { return GetBindingPoint(entry) < b; });
+			if (it != table.end() && GetBindingPoint(*it) == binding)
+				*it = value;
+			else
+				table.insert(it, value);
+		}
+
+		static VulkanShader::ShaderDescriptor& AddDescriptor(VulkanShader::ShaderDescriptorSet& shaderDescriptorSet, const std::string& name, const VkDescriptorSetLayoutBinding& layoutBinding)
+		{
+			VulkanShader::ShaderDescriptor& descriptor = shaderDescriptorSet.Descriptors.emplace_back();
+			descriptor.Name = name;
+			descriptor.NameHash = Hash::GenerateFNVHash(name);
+			descriptor.Binding = layoutBinding.binding;
+			descriptor.Write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptor.Write.descriptorType = layoutBinding.descriptorType;
+			descriptor.Write.descriptorCount = layoutBinding.descriptorCount;
+			descriptor.Write.dstBinding = layoutBinding.binding;
+			return descriptor;
+		}
+
+		static uint32_t FindDescriptor(const VulkanShader::ShaderDescriptorSet& shaderDescriptorSet, const std::string& name)
+		{
+			uint32_t nameHash = Hash::GenerateFNVHash(name);
+			for (uint32_t i = 0; i < (uint32_t)shaderDescriptorSet.Descriptors.size(); i++)
+			{
+				const auto& descriptor = shaderDescriptorSet.Descriptors[i];
+				if (descriptor.NameHash == nameHash && descriptor.Name == name)
+					return i;
+			}
+			return UINT32_MAX;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////////////
@@ -66,29 +161,114 @@ namespace Xero {
 
 	static std::unordered_map<uint32_t, std::unordered_map<uint32_t, VulkanShader::UniformBuffer*>> s_UniformBuffers; // set -> binding point -> buffer
 	static std::unordered_map<uint32_t, std::unordered_map<uint32_t, VulkanShader::StorageBuffer*>> s_StorageBuffers; // set -> binding point -> buffer
+	static std::mutex s_BufferRegistryMutex; // Hot reloads reflect on worker threads
+
+	// Shaders that are watched for hot reload, only touched on the main thread
+	static std::unordered_set<VulkanShader*> s_WatchedShaders;
+
+	static FileWatcher& GetShaderWatcher()
+	{
+		static FileWatcher watcher;
+		return watcher;
+	}
+
+	static VulkanShader::UniformBuffer* RegisterUniformBuffer(uint32_t descriptorSet, uint32_t binding, const std::string& name, uint32_t size)
+	{
+		std::scoped_lock<std::mutex> lock(s_BufferRegistryMutex);
+		if (s_UniformBuffers[descriptorSet].find(binding) == s_UniformBuffers[descriptorSet].end())
+		{
+			VulkanShader::UniformBuffer* uniformBuffer = new VulkanShader::UniformBuffer();
+			uniformBuffer->BindingPoint = binding;
+			uniformBuffer->Size = size;
+			uniformBuffer->Name = name;
+			uniformBuffer->ShaderStage = VK_SHADER_STAGE_ALL;
+			// Backed by the uniform ring, the frame and the draw are selected through the dynamic offset
+			uniformBuffer->Descriptor.buffer = VulkanRenderer::GetUniformBufferRing().GetBuffer();
+			uniformBuffer->Descriptor.offset = 0;
+			uniformBuffer->Descriptor.range = size;
+			s_UniformBuffers.at(descriptorSet)[binding] = uniformBuffer;
+		}
+		else
+		{
+			VulkanShader::UniformBuffer* uniformBuffer = s_UniformBuffers.at(descriptorSet)[binding];
+			if (size > uniformBuffer->Size)
+			{
+				uniformBuffer->Size = size;
+				uniformBuffer->Descriptor.range = size;
+			}
+		}
+
+		return s_UniformBuffers.at(descriptorSet)[binding];
+	}
+
+	static VulkanShader::StorageBuffer* RegisterStorageBuffer(uint32_t descriptorSet, uint32_t binding, const std::string& name, uint32_t size)
+	{
+		std::scoped_lock<std::mutex> lock(s_BufferRegistryMutex);
+		if (s_StorageBuffers[descriptorSet].find(binding) == s_StorageBuffers[descriptorSet].end())
+		{
+			VulkanShader::StorageBuffer* storageBuffer = new VulkanShader::StorageBuffer();
+			storageBuffer->BindingPoint = binding;
+			storageBuffer->Size = size;
+			storageBuffer->Name = name;
+			storageBuffer->ShaderStage = VK_SHADER_STAGE_ALL;
+			s_StorageBuffers.at(descriptorSet)[binding] = storageBuffer;
+		}
+		else
+		{
+			VulkanShader::StorageBuffer* storageBuffer = s_StorageBuffers.at(descriptorSet).at(binding);
+			if (size > storageBuffer->Size)
+				storageBuffer->Size = size;
+		}
+
+		return s_StorageBuffers.at(descriptorSet).at(binding);
+	}
 
 	//////////////////////////////////////////////////////////////////////////////////
 	// Shaders
 	//////////////////////////////////////////////////////////////////////////////////
 
-	VulkanShader::VulkanShader(const std::string& path, bool forceCompile)
+	VulkanShader::VulkanShader(const std::string& path)
 		: m_AssetPath(path)
 	{
 		size_t found = path.find_last_of("/\\");
 		m_Name = found != std::string::npos ? path.substr(found + 1) : path;
 		found = m_Name.find_last_of(".");
 		m_Name = found != std::string::npos ? m_Name.substr(0, found) : m_Name;
+	}
 
+	VulkanShader::VulkanShader(const std::string& path, bool forceCompile)
+		: VulkanShader(path)
+	{
 		Reload(forceCompile);
+		WatchForChanges();
 	}
 
 	VulkanShader::~VulkanShader()
 	{
+		// The worker only holds a raw pointer to us, so let it finish first
+		if (m_PendingReload.valid())
+		{
+			VulkanShader* staging = m_PendingReload.get();
+			if (staging)
+			{
+				staging->DestroyShaderModules();
+				staging->DestroyDescriptorUpdateTemplates();
+				delete staging;
+			}
+		}
 
+		DestroyDescriptorUpdateTemplates();
+
+		if (m_Watched)
+		{
+			s_WatchedShaders.erase(this);
+			GetShaderWatcher().Unwatch(m_AssetPath);
+		}
 	}
 
 	void VulkanShader::ClearUniformBuffers()
 	{
+		std::scoped_lock<std::mutex> lock(s_BufferRegistryMutex);
 		s_UniformBuffers.clear();
 		s_StorageBuffers.clear();
 	}
@@ -106,15 +286,211 @@ namespace Xero {
 		}
 		else
 		{
-			XO_CORE_ASSERT(false, "Could not load shader!");
+			XO_CORE_ERROR("Could not load shader {0}", filepath);
 		}
 		in.close();
 		return result;
 	}
 
+	std::vector<Ref<Shader>> VulkanShader::CreateBatch(const std::vector<std::string>& paths, bool forceCompile)
+	{
+		Timer timer;
+
+		Utils::CreateCacheDirectoryIfNeeded();
+
+		// Every stage updates the manifest, write it out once for the whole batch
+		ShaderCache& shaderCache = Utils::GetShaderCache();
+		shaderCache.BeginBatch();
+
+		std::vector<Ref<VulkanShader>> shaders;
+		shaders.reserve(paths.size());
+		for (const auto& path : paths)
+			shaders.push_back(Ref<VulkanShader>(new VulkanShader(path)));
+
+		// Ref counts are not atomic, so the workers only get raw pointers
+		std::vector<std::future<bool>> jobs;
+		jobs.reserve(shaders.size());
+		for (auto& shader : shaders)
+		{
+			VulkanShader* instance = shader.Raw();
+			jobs.push_back(ThreadPool::Get().Submit([instance, forceCompile]()
+			{
+				if (!instance->Compile(forceCompile))
+					return false;
+
+				instance->ReflectShaderData(forceCompile);
+				return true;
+			}));
+		}
+
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			bool compiled = jobs[i].get();
+			if (!compiled)
+				XO_CORE_ERROR("Failed to compile shader {0}", paths[i]);
+			XO_CORE_ASSERT(compiled, "Failed to compile shader");
+		}
+
+		// Module creation and the shared buffer registry stay on the calling thread
+		std::vector<Ref<Shader>> result;
+		result.reserve(shaders.size());
+		for (auto& shader : shaders)
+		{
+			shader->Finalize();
+			shader->WatchForChanges();
+			result.push_back(shader);
+		}
+
+		shaderCache.EndBatch();
+
+		XO_CORE_INFO("Loaded {0} shaders in {1}ms ({2} worker threads)", shaders.size(), timer.ElapsedMillis(), ThreadPool::Get().GetThreadCount());
+		return result;
+	}
+
 	void VulkanShader::Reload(bool forceCompile /*= false*/)
 	{
-		// Clear old shader
+		Timer timer;
+		uint32_t previousContentHash = m_ContentHash;
+
+		// Compile drops the descriptor sets without touching the device
+		DestroyDescriptorUpdateTemplates();
+
+		bool compiled = Compile(forceCompile);
+		if (!compiled)
+			XO_CORE_ERROR("Failed to compile shader {0}", m_AssetPath);
+		XO_CORE_ASSERT(compiled, "Failed to compile shader");
+		ReflectShaderData(forceCompile);
+		Finalize();
+
+		// Zero on the first load, nothing has been built from this shader yet
+		if (previousContentHash != 0 && previousContentHash != m_ContentHash)
+			VulkanRenderer::GetPipelineStateCache().EvictShader(GetHash(), previousContentHash);
+
+		XO_CORE_TRACE("Shader {0} loaded in {1}ms", m_Name, timer.ElapsedMillis());
+
+		for (auto& callback : m_ReloadedCallbacks)
+			callback();
+	}
+
+	void VulkanShader::ReloadAsync(bool forceCompile /*= false*/)
+	{
+		// A change that lands mid-compile is picked up once the current job is swapped in
+		if (m_PendingReload.valid())
+		{
+			m_ReloadQueued = true;
+			return;
+		}
+
+		// The replacement is compiled and reflected off the main thread. Modules, the buffer registry and descriptors are
+		// only touched by ProcessHotReload, the live shader is untouched until the swap
+		std::string path = m_AssetPath;
+		m_PendingReload = ThreadPool::Get().Submit([path, forceCompile]() -> VulkanShader*
+		{
+			Timer timer;
+
+			VulkanShader* staging = new VulkanShader(path);
+			if (!staging->Compile(forceCompile))
+			{
+				XO_CORE_ERROR("Hot reload of {0} failed, keeping the previous version", path);
+				delete staging;
+				return nullptr;
+			}
+
+			staging->ReflectShaderData(forceCompile);
+			XO_CORE_TRACE("Shader {0} recompiled in {1}ms", staging->m_Name, timer.ElapsedMillis());
+			return staging;
+		});
+	}
+
+	void VulkanShader::ProcessHotReload()
+	{
+		for (const auto& path : GetShaderWatcher().Poll())
+		{
+			for (VulkanShader* shader : s_WatchedShaders)
+			{
+				if (FileWatcher::Normalize(shader->m_AssetPath) == path)
+					shader->ReloadAsync();
+			}
+		}
+
+		// Held by Ref, a callback may drop the last other reference to any of them
+		std::vector<Ref<VulkanShader>> reloaded;
+		for (VulkanShader* shader : s_WatchedShaders)
+		{
+			if (!shader->m_PendingReload.valid() || shader->m_PendingReload.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				continue;
+
+			VulkanShader* staging = shader->m_PendingReload.get();
+			if (staging)
+			{
+				staging->Finalize();
+
+				// Pipelines hold their own copy of the code, so the old modules can go right away
+				shader->SwapShaderData(*staging);
+				staging->DestroyShaderModules();
+				staging->DestroyDescriptorUpdateTemplates();
+
+				// The staging shader now holds the previous content hash
+				if (staging->m_ContentHash != shader->m_ContentHash)
+					VulkanRenderer::GetPipelineStateCache().EvictShader(shader->GetHash(), staging->m_ContentHash);
+				delete staging;
+
+				reloaded.push_back(shader);
+			}
+
+			if (shader->m_ReloadQueued)
+			{
+				shader->m_ReloadQueued = false;
+				shader->ReloadAsync();
+			}
+		}
+
+		for (const Ref<VulkanShader>& shader : reloaded)
+		{
+			XO_CORE_INFO("Hot reloaded shader {0}", shader->m_Name);
+			for (auto& callback : shader->m_ReloadedCallbacks)
+				callback();
+		}
+	}
+
+	void VulkanShader::WatchForChanges()
+	{
+		if (m_Watched)
+			return;
+
+		GetShaderWatcher().Watch(m_AssetPath);
+		s_WatchedShaders.insert(this);
+		m_Watched = true;
+	}
+
+	void VulkanShader::SwapShaderData(VulkanShader& other)
+	{
+		std::swap(m_PipelineShaderStageCreateInfos, other.m_PipelineShaderStageCreateInfos);
+		std::swap(m_ShaderSource, other.m_ShaderSource);
+		std::swap(m_ShaderDescriptorSets, other.m_ShaderDescriptorSets);
+		std::swap(m_ReflectedUniformBuffers, other.m_ReflectedUniformBuffers);
+		std::swap(m_ReflectedStorageBuffers, other.m_ReflectedStorageBuffers);
+		std::swap(m_PushConstantRanges, other.m_PushConstantRanges);
+		std::swap(m_Resources, other.m_Resources);
+		std::swap(m_Buffers, other.m_Buffers);
+		std::swap(m_DescriptorSetLayouts, other.m_DescriptorSetLayouts);
+		std::swap(m_DescriptorSet, other.m_DescriptorSet);
+		std::swap(m_TypeCounts, other.m_TypeCounts);
+		std::swap(m_ContentHash, other.m_ContentHash);
+	}
+
+	void VulkanShader::DestroyShaderModules()
+	{
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		for (auto& shaderStage : m_PipelineShaderStageCreateInfos)
+			vkDestroyShaderModule(device, shaderStage.module, nullptr);
+
+		m_PipelineShaderStageCreateInfos.clear();
+	}
+
+	bool VulkanShader::Compile(bool forceCompile)
+	{
+		// Clear old shader, its templates are destroyed by the caller on the main thread
 		m_ShaderDescriptorSets.clear();
 		m_Resources.clear();
 		m_PushConstantRanges.clear();
@@ -123,22 +499,69 @@ namespace Xero {
 		m_ShaderSource.clear();
 		m_Buffers.clear();
 		m_TypeCounts.clear();
+		m_ReflectedUniformBuffers.clear();
+		m_ReflectedStorageBuffers.clear();
 
 		Utils::CreateCacheDirectoryIfNeeded();
 
 		// Vertex and Fragment for now
 		std::string source = ReadShaderFromFile(m_AssetPath);
-
-		// TODO: Save shader hashes so we know when to re-compile out-of-date shaders
-		uint32_t hash = Hash::GenerateFNVHash(source.c_str());
+		if (source.empty())
+			return false;
 
 		m_ShaderSource = PreProcess(source);
-		std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> shaderData;
-		CompileOrGetVulkanBinary(shaderData, forceCompile);
-		LoadAndCreateShaders(shaderData);
-		ReflectAllShaderStages(shaderData);
+		m_ShaderData.clear();
+		CompileOrGetVulkanBinary(m_ShaderData, forceCompile);
+
+		for (const auto& [stage, data] : m_ShaderData)
+		{
+			if (data.empty())
+				return false;
+		}
+
+		return true;
+	}
+
+	void VulkanShader::ReflectShaderData(bool forceCompile)
+	{
+		// Warm loads go straight from the sidecar to the descriptor tables without running SPIRV-Cross
+		if (forceCompile || !TryReadReflectionData())
+		{
+			ReflectAllShaderStages(m_ShaderData);
+			SerializeReflectionData();
+		}
+
+		m_ContentHash = GetReflectionHash();
+	}
+
+	void VulkanShader::Finalize()
+	{
+		LoadAndCreateShaders(m_ShaderData);
+
+		// Buffers are shared between shaders, a larger declaration grows the registry entry for sets created from now on
+		for (const auto& buffer : m_ReflectedUniformBuffers)
+			Utils::SetBinding(m_ShaderDescriptorSets[buffer.Set].UniformBuffers, RegisterUniformBuffer(buffer.Set, buffer.Binding, buffer.Name, buffer.Size));
+		for (const auto& buffer : m_ReflectedStorageBuffers)
+			Utils::SetBinding(m_ShaderDescriptorSets[buffer.Set].StorageBuffers, RegisterStorageBuffer(buffer.Set, buffer.Binding, buffer.Name, buffer.Size));
 
 		CreateDescriptors();
+
+		m_ShaderData.clear();
+	}
+
+	void VulkanShader::AddReflectedBuffer(std::vector<ReflectedBuffer>& buffers, const ReflectedBuffer& buffer)
+	{
+		// Stages reflect the same binding again, the last one wins
+		for (auto& existing : buffers)
+		{
+			if (existing.Set == buffer.Set && existing.Binding == buffer.Binding)
+			{
+				existing = buffer;
+				return;
+			}
+		}
+
+		buffers.push_back(buffer);
 	}
 
 	size_t VulkanShader::GetHash() const
@@ -180,8 +603,6 @@ namespace Xero {
 
 	void VulkanShader::Reflect(VkShaderStageFlagBits shaderStage, const std::vector<uint32_t>& shaderData)
 	{
-		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
-
 		XO_CORE_TRACE("===========================");
 		XO_CORE_TRACE(" Vulkan Shader Reflection");
 		XO_CORE_TRACE(" {0}", m_AssetPath);
@@ -203,24 +624,7 @@ namespace Xero {
 			if (descriptorSet >= m_ShaderDescriptorSets.size())
 				m_ShaderDescriptorSets.resize(descriptorSet + 1);
 
-			ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[descriptorSet];
-			if (s_UniformBuffers[descriptorSet].find(binding) == s_UniformBuffers[descriptorSet].end())
-			{
-				UniformBuffer* uniformBuffer = new UniformBuffer();
-				uniformBuffer->BindingPoint = binding;
-				uniformBuffer->Size = size;
-				uniformBuffer->Name = name;
-				uniformBuffer->ShaderStage = VK_SHADER_STAGE_ALL;
-				s_UniformBuffers.at(descriptorSet)[binding] = uniformBuffer;
-			}
-			else
-			{
-				UniformBuffer* uniformBuffer = s_UniformBuffers.at(descriptorSet)[binding];
-				if (size > uniformBuffer->Size)
-					uniformBuffer->Size = size;
-			}
-
-			shaderDescriptorSet.UniformBuffers[binding] = s_UniformBuffers.at(descriptorSet)[binding];
+			AddReflectedBuffer(m_ReflectedUniformBuffers, { descriptorSet, binding, size, name });
 
 			XO_CORE_TRACE("  {0} ({1}, {2})", name, descriptorSet, binding);
 			XO_CORE_TRACE("  Member Count: {0}", memberCount);
@@ -241,24 +645,7 @@ namespace Xero {
 			if (descriptorSet >= m_ShaderDescriptorSets.size())
 				m_ShaderDescriptorSets.resize(descriptorSet + 1);
 
-			ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[descriptorSet];
-			if (s_StorageBuffers[descriptorSet].find(binding) == s_StorageBuffers[descriptorSet].end())
-			{
-				StorageBuffer* storageBuffer = new StorageBuffer();
-				storageBuffer->BindingPoint = binding;
-				storageBuffer->Size = size;
-				storageBuffer->Name = name;
-				storageBuffer->ShaderStage = VK_SHADER_STAGE_ALL;
-				s_StorageBuffers.at(descriptorSet)[binding] = storageBuffer;
-			}
-			else
-			{
-				StorageBuffer* storageBuffer = s_StorageBuffers.at(descriptorSet).at(binding);
-				if (size > storageBuffer->Size)
-					storageBuffer->Size = size;
-			}
-
-			shaderDescriptorSet.StorageBuffers[binding] = s_StorageBuffers.at(descriptorSet).at(binding);
+			AddReflectedBuffer(m_ReflectedStorageBuffers, { descriptorSet, binding, size, name });
 
 			XO_CORE_TRACE("  {0} ({1}, {2})", name, descriptorSet, binding);
 			XO_CORE_TRACE("  Member Count: {0}", memberCount);
@@ -315,19 +702,18 @@ namespace Xero {
 			uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
 			uint32_t descriptorSet = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
 			uint32_t dimension = baseType.image.dim;
-			uint32_t arraySize = type.array[0];
-			if (arraySize == 0)
-				arraySize = 1;
+			// Unsized arrays reflect as 0, they are only valid on the bindless set
+			uint32_t arraySize = type.array.empty() ? 1 : type.array[0];
 			if (descriptorSet >= m_ShaderDescriptorSets.size())
 				m_ShaderDescriptorSets.resize(descriptorSet + 1);
 
-			ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[descriptorSet];
-			auto& imageSampler = shaderDescriptorSet.ImageSamplers[binding];
+			ImageSampler imageSampler;
 			imageSampler.BindingPoint = binding;
 			imageSampler.DescriptorSet = descriptorSet;
 			imageSampler.Name = name;
 			imageSampler.ShaderStage = shaderStage;
 			imageSampler.ArraySize = arraySize;
+			Utils::SetBinding(m_ShaderDescriptorSets[descriptorSet].ImageSamplers, imageSampler);
 
 			m_Resources[name] = ShaderResourceDeclaration(name, binding, 1);
 
@@ -346,12 +732,12 @@ namespace Xero {
 			if (descriptorSet >= m_ShaderDescriptorSets.size())
 				m_ShaderDescriptorSets.resize(descriptorSet + 1);
 
-			ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[descriptorSet];
-			auto& imageSampler = shaderDescriptorSet.StorageImages[binding];
+			ImageSampler imageSampler;
 			imageSampler.BindingPoint = binding;
 			imageSampler.DescriptorSet = descriptorSet;
 			imageSampler.Name = name;
 			imageSampler.ShaderStage = shaderStage;
+			Utils::SetBinding(m_ShaderDescriptorSets[descriptorSet].StorageImages, imageSampler);
 
 			m_Resources[name] = ShaderResourceDeclaration(name, binding, 1);
 
@@ -374,10 +760,27 @@ namespace Xero {
 		{
 			auto& shaderDescriptorSet = m_ShaderDescriptorSets[set];
 
+			// The global table replaces the shader's own set, nothing is allocated or written for it per shader
+			if (set == VulkanBindlessTable::DescriptorSetIndex && VulkanRenderer::IsBindlessEnabled())
+			{
+				XO_CORE_ASSERT(shaderDescriptorSet.UniformBuffers.empty(), "The bindless set has no uniform buffers");
+				for (auto& imageSampler : shaderDescriptorSet.ImageSamplers)
+					XO_CORE_ASSERT(imageSampler.BindingPoint == VulkanBindlessTable::TextureBinding, "Bindless textures live at binding 0");
+				for (auto* storageBuffer : shaderDescriptorSet.StorageBuffers)
+					XO_CORE_ASSERT(storageBuffer->BindingPoint == VulkanBindlessTable::StorageBufferBinding, "Bindless storage buffers live at binding 1");
+				for (auto& storageImage : shaderDescriptorSet.StorageImages)
+					XO_CORE_ASSERT(storageImage.BindingPoint == VulkanBindlessTable::StorageImageBinding, "Bindless storage images live at binding 2");
+
+				if (set >= m_DescriptorSetLayouts.size())
+					m_DescriptorSetLayouts.resize((size_t)(set + 1));
+				m_DescriptorSetLayouts[set] = VulkanRenderer::GetBindlessTable().GetDescriptorSetLayout();
+				continue;
+			}
+
 			if (shaderDescriptorSet.UniformBuffers.size())
 			{
 				VkDescriptorPoolSize& typeCount = m_TypeCounts[set].emplace_back();
-				typeCount.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				typeCount.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 				typeCount.descriptorCount = (uint32_t)(shaderDescriptorSet.UniformBuffers.size());
 			}
 			if (shaderDescriptorSet.StorageBuffers.size())
@@ -390,7 +793,10 @@ namespace Xero {
 			{
 				VkDescriptorPoolSize& typeCount = m_TypeCounts[set].emplace_back();
 				typeCount.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				typeCount.descriptorCount = (uint32_t)(shaderDescriptorSet.ImageSamplers.size());
+				// Arrays take one descriptor per element
+				typeCount.descriptorCount = 0;
+				for (const auto& imageSampler : shaderDescriptorSet.ImageSamplers)
+					typeCount.descriptorCount += std::max(imageSampler.ArraySize, 1u);
 			}
 			if (shaderDescriptorSet.StorageImages.size())
 			{
@@ -399,102 +805,78 @@ namespace Xero {
 				typeCount.descriptorCount = (uint32_t)(shaderDescriptorSet.StorageImages.size());
 			}
 
-			#if 0
-			// TODO: Move this to the centralized renderer
-			VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
-			descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-			descriptorPoolInfo.pNext = nullptr;
-			descriptorPoolInfo.poolSizeCount = m_TypeCounts.size();
-			descriptorPoolInfo.pPoolSizes = m_TypeCounts.data();
-			descriptorPoolInfo.maxSets = 1;
-
-			VK_CHECK_RESULT(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &m_DescriptorPool));
-			#endif
-
 			//////////////////////////////////////////////////////////////////////
 			// Descriptor Set Layout
 			//////////////////////////////////////////////////////////////////////
 
 
 			std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
-			for (auto& [binding, uniformBuffer] : shaderDescriptorSet.UniformBuffers)
+			shaderDescriptorSet.Descriptors.clear();
+			for (auto* uniformBuffer : shaderDescriptorSet.UniformBuffers)
 			{
 				VkDescriptorSetLayoutBinding& layoutBinding = layoutBindings.emplace_back();
-				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 				layoutBinding.descriptorCount = 1;
 				layoutBinding.stageFlags = uniformBuffer->ShaderStage;
 				layoutBinding.pImmutableSamplers = nullptr;
-				layoutBinding.binding = binding;
+				layoutBinding.binding = uniformBuffer->BindingPoint;
 
-				VkWriteDescriptorSet& set = shaderDescriptorSet.WriteDescriptorSets[uniformBuffer->Name];
-				set = {};
-				set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				set.descriptorType = layoutBinding.descriptorType;
-				set.descriptorCount = 1;
-				set.dstBinding = layoutBinding.binding;
+				ShaderDescriptor& descriptor = Utils::AddDescriptor(shaderDescriptorSet, uniformBuffer->Name, layoutBinding);
+				descriptor.Write.pBufferInfo = &uniformBuffer->Descriptor;
 			}
 
-			for (auto& [binding, strorageBuffer] : shaderDescriptorSet.StorageBuffers)
+			for (auto* storageBuffer : shaderDescriptorSet.StorageBuffers)
 			{
 				VkDescriptorSetLayoutBinding& layoutBinding = layoutBindings.emplace_back();
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 				layoutBinding.descriptorCount = 1;
-				layoutBinding.stageFlags = strorageBuffer->ShaderStage;
+				layoutBinding.stageFlags = storageBuffer->ShaderStage;
 				layoutBinding.pImmutableSamplers = nullptr;
-				layoutBinding.binding = binding;
+				layoutBinding.binding = storageBuffer->BindingPoint;
 
-				VkWriteDescriptorSet& set = shaderDescriptorSet.WriteDescriptorSets[strorageBuffer->Name];
-				set = {};
-				set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				set.descriptorType = layoutBinding.descriptorType;
-				set.descriptorCount = 1;
-				set.dstBinding = layoutBinding.binding;
+				Utils::AddDescriptor(shaderDescriptorSet, storageBuffer->Name, layoutBinding);
 			}
 
-			for (auto& [binding, imageSampler] : shaderDescriptorSet.ImageSamplers)
+			for (auto& imageSampler : shaderDescriptorSet.ImageSamplers)
 			{
+				if (imageSampler.ArraySize == 0)
+				{
+					XO_CORE_ERROR("Shader {0}: unsized sampler array {1} needs the bindless set ({2}) with RendererConfig::Bindless", m_Name, imageSampler.Name, VulkanBindlessTable::DescriptorSetIndex);
+					imageSampler.ArraySize = 1;
+				}
+
 				auto& layoutBinding = layoutBindings.emplace_back();
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 				layoutBinding.descriptorCount = imageSampler.ArraySize;
 				layoutBinding.stageFlags = imageSampler.ShaderStage;
 				layoutBinding.pImmutableSamplers = nullptr;
-				layoutBinding.binding = binding;
+				layoutBinding.binding = imageSampler.BindingPoint;
 
-				XO_CORE_ASSERT(shaderDescriptorSet.UniformBuffers.find(binding) == shaderDescriptorSet.UniformBuffers.end(), "Binding is already present!");
-				XO_CORE_ASSERT(shaderDescriptorSet.StorageBuffers.find(binding) == shaderDescriptorSet.StorageBuffers.end(), "Binding is already present!");
+				XO_CORE_ASSERT(!Utils::HasBinding(shaderDescriptorSet.UniformBuffers, imageSampler.BindingPoint), "Binding is already present!");
+				XO_CORE_ASSERT(!Utils::HasBinding(shaderDescriptorSet.StorageBuffers, imageSampler.BindingPoint), "Binding is already present!");
 
-				VkWriteDescriptorSet& set = shaderDescriptorSet.WriteDescriptorSets[imageSampler.Name];
-				set = {};
-				set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				set.descriptorType = layoutBinding.descriptorType;
-				set.descriptorCount = imageSampler.ArraySize;
-				set.dstBinding = layoutBinding.binding;
+				Utils::AddDescriptor(shaderDescriptorSet, imageSampler.Name, layoutBinding);
 			}
 
-			for (auto& [bindingAndSet, imageSampler] : shaderDescriptorSet.StorageImages)
+			for (auto& storageImage : shaderDescriptorSet.StorageImages)
 			{
 				auto& layoutBinding = layoutBindings.emplace_back();
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 				layoutBinding.descriptorCount = 1;
-				layoutBinding.stageFlags = imageSampler.ShaderStage;
+				layoutBinding.stageFlags = storageImage.ShaderStage;
 				layoutBinding.pImmutableSamplers = nullptr;
+				layoutBinding.binding = storageImage.BindingPoint;
 
-				uint32_t binding = bindingAndSet & 0xffffffff;
-				//uint32_t descriptorSet = (bindingAndSet >> 32);
-				layoutBinding.binding = binding;
+				XO_CORE_ASSERT(!Utils::HasBinding(shaderDescriptorSet.UniformBuffers, storageImage.BindingPoint), "Binding is already present!");
+				XO_CORE_ASSERT(!Utils::HasBinding(shaderDescriptorSet.StorageBuffers, storageImage.BindingPoint), "Binding is already present!");
+				XO_CORE_ASSERT(!Utils::HasBinding(shaderDescriptorSet.ImageSamplers, storageImage.BindingPoint), "Binding is already present!");
 
-				XO_CORE_ASSERT(shaderDescriptorSet.UniformBuffers.find(binding) == shaderDescriptorSet.UniformBuffers.end(), "Binding is already present!");
-				XO_CORE_ASSERT(shaderDescriptorSet.StorageBuffers.find(binding) == shaderDescriptorSet.StorageBuffers.end(), "Binding is already present!");
-				XO_CORE_ASSERT(shaderDescriptorSet.ImageSamplers.find(binding) == shaderDescriptorSet.ImageSamplers.end(), "Binding is already present!");
-
-				VkWriteDescriptorSet& set = shaderDescriptorSet.WriteDescriptorSets[imageSampler.Name];
-				set = {};
-				set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				set.descriptorType = layoutBinding.descriptorType;
-				set.descriptorCount = 1;
-				set.dstBinding = layoutBinding.binding;
+				Utils::AddDescriptor(shaderDescriptorSet, storageImage.Name, layoutBinding);
 			}
 
+			// Handles index this table, so its order is fixed from here on
+			std::sort(shaderDescriptorSet.Descriptors.begin(), shaderDescriptorSet.Descriptors.end(), [](const ShaderDescriptor& a, const ShaderDescriptor& b) { return a.Binding < b.Binding; });
+
 			VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
 			descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 			descriptorLayout.pNext = nullptr;
@@ -508,106 +890,131 @@ namespace Xero {
 				shaderDescriptorSet.StorageImages.size());
 			if (set >= m_DescriptorSetLayouts.size())
 				m_DescriptorSetLayouts.resize((size_t)(set + 1));
-			VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &descriptorLayout, nullptr, &m_DescriptorSetLayouts[set]));
+
+			// Shaders commonly share their scene and material sets, those resolve to one layout handle
+			m_DescriptorSetLayouts[set] = VulkanRenderer::GetDescriptorSetLayoutCache().GetOrCreate(descriptorLayout);
+
+			//////////////////////////////////////////////////////////////////////
+			// Descriptor Update Template
+			//////////////////////////////////////////////////////////////////////
+
+			if (layoutBindings.empty())
+				continue;
+
+			// Every binding of the set packed into one block in binding order, see DescriptorSetData
+			std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+			uint32_t dataSize = 0;
+			for (auto& descriptor : shaderDescriptorSet.Descriptors)
+			{
+				const VkWriteDescriptorSet& write = descriptor.Write;
+				uint32_t stride = Utils::IsImageDescriptor(write.descriptorType) ? sizeof(VkDescriptorImageInfo) : sizeof(VkDescriptorBufferInfo);
+
+				VkDescriptorUpdateTemplateEntry& entry = templateEntries.emplace_back();
+				entry.dstBinding = write.dstBinding;
+				entry.dstArrayElement = 0;
+				entry.descriptorCount = write.descriptorCount;
+				entry.descriptorType = write.descriptorType;
+				entry.offset = dataSize;
+				entry.stride = stride;
+
+				descriptor.TemplateEntry = { write.dstBinding, dataSize, write.descriptorCount, write.descriptorType };
+				dataSize += stride * write.descriptorCount;
+			}
+
+			VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+			templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+			templateInfo.descriptorUpdateEntryCount = (uint32_t)templateEntries.size();
+			templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+			templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+			templateInfo.descriptorSetLayout = m_DescriptorSetLayouts[set];
+			VK_CHECK_RESULT(vkCreateDescriptorUpdateTemplate(device, &templateInfo, nullptr, &shaderDescriptorSet.UpdateTemplate));
+			shaderDescriptorSet.TemplateDataSize = dataSize;
 		}
 	}
 
-	Xero::VulkanShader::ShaderMaterialDescriptorSet VulkanShader::CreateDescriptorSets(uint32_t set /*= 0*/)
+	void VulkanShader::DestroyDescriptorUpdateTemplates()
 	{
-		ShaderMaterialDescriptorSet result;
-
 		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		for (auto& shaderDescriptorSet : m_ShaderDescriptorSets)
+		{
+			// Only referenced by host calls, nothing in flight on the GPU depends on them
+			if (shaderDescriptorSet.UpdateTemplate)
+				vkDestroyDescriptorUpdateTemplate(device, shaderDescriptorSet.UpdateTemplate, nullptr);
+			shaderDescriptorSet.UpdateTemplate = VK_NULL_HANDLE;
+		}
+	}
 
-		XO_CORE_ASSERT(m_TypeCounts.find(set) != m_TypeCounts.end());
-
-		// TODO: Move this to the centralized renderer
-		VkDescriptorPoolCreateInfo descriptorPoolInfo{};
-		descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		descriptorPoolInfo.pNext = nullptr;
-		descriptorPoolInfo.poolSizeCount = (uint32_t)m_TypeCounts.at(set).size();
-		descriptorPoolInfo.pPoolSizes = m_TypeCounts.at(set).data();
-		descriptorPoolInfo.maxSets = 1;
+	VulkanShader::DescriptorSetData VulkanShader::CreateDescriptorSetData(uint32_t set /*= 0*/) const
+	{
+		XO_CORE_ASSERT(set < m_ShaderDescriptorSets.size());
+		const ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[set];
 
-		VK_CHECK_RESULT(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &result.Pool));
+		DescriptorSetData result;
+		result.Set = set;
+		result.Data.resize(shaderDescriptorSet.TemplateDataSize);
 
-		VkDescriptorSetAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = result.Pool;
-		allocInfo.descriptorSetCount = 1;
-		allocInfo.pSetLayouts = &m_DescriptorSetLayouts[set];
+		// Uniform buffers always point at the ring, only their dynamic offset changes
+		for (const auto& descriptor : shaderDescriptorSet.Descriptors)
+		{
+			if (descriptor.Write.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+				SetBuffer(result, descriptor.TemplateEntry, *descriptor.Write.pBufferInfo);
+		}
 
-		result.DescriptorSets.emplace_back();
-		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, result.DescriptorSets.data()));
 		return result;
 	}
 
-	Xero::VulkanShader::ShaderMaterialDescriptorSet VulkanShader::CreateDescriptorSets(uint32_t set, uint32_t numberOfSets)
+	const VulkanShader::DescriptorTemplateEntry* VulkanShader::GetDescriptorTemplateEntry(const std::string& name, uint32_t set /*= 0*/) const
 	{
-		ShaderMaterialDescriptorSet result;
-
-		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
-
-		std::unordered_map<uint32_t, std::vector<VkDescriptorPoolSize>> poolSizes;
-		for (uint32_t set = 0; set < m_ShaderDescriptorSets.size(); set++)
-		{
-			auto& shaderDescriptorSet = m_ShaderDescriptorSets[set];
-			if (!shaderDescriptorSet) // Empty descriptor set
-				continue;
+		ShaderResourceHandle handle = GetResourceHandle(name, set);
+		return handle ? &GetDescriptorTemplateEntry(handle) : nullptr;
+	}
 
-			if (shaderDescriptorSet.UniformBuffers.size())
-			{
-				VkDescriptorPoolSize& typeCount = poolSizes[set].emplace_back();
-				typeCount.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-				typeCount.descriptorCount = (uint32_t)shaderDescriptorSet.UniformBuffers.size() * numberOfSets;
-			}
-			if (shaderDescriptorSet.StorageBuffers.size())
-			{
-				VkDescriptorPoolSize& typeCount = poolSizes[set].emplace_back();
-				typeCount.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-				typeCount.descriptorCount = (uint32_t)shaderDescriptorSet.StorageBuffers.size() * numberOfSets;
-			}
-			if (shaderDescriptorSet.ImageSamplers.size())
-			{
-				VkDescriptorPoolSize& typeCount = poolSizes[set].emplace_back();
-				typeCount.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				uint32_t descriptorSetCount = 0;
-				for (auto&& [binding, imageSampler] : shaderDescriptorSet.ImageSamplers)
-					descriptorSetCount += imageSampler.ArraySize;
+	void VulkanShader::SetImage(DescriptorSetData& data, const DescriptorTemplateEntry& entry, const VkDescriptorImageInfo& imageInfo, uint32_t arrayIndex /*= 0*/)
+	{
+		XO_CORE_ASSERT(Utils::IsImageDescriptor(entry.Type) && arrayIndex < entry.Count);
+		memcpy(data.Data.data() + entry.Offset + arrayIndex * sizeof(VkDescriptorImageInfo), &imageInfo, sizeof(VkDescriptorImageInfo));
+	}
 
-				typeCount.descriptorCount = descriptorSetCount * numberOfSets;
-			}
-			if (shaderDescriptorSet.StorageImages.size())
-			{
-				VkDescriptorPoolSize& typeCount = poolSizes[set].emplace_back();
-				typeCount.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-				typeCount.descriptorCount = (uint32_t)shaderDescriptorSet.StorageImages.size() * numberOfSets;
-			}
+	void VulkanShader::SetBuffer(DescriptorSetData& data, const DescriptorTemplateEntry& entry, const VkDescriptorBufferInfo& bufferInfo, uint32_t arrayIndex /*= 0*/)
+	{
+		XO_CORE_ASSERT(!Utils::IsImageDescriptor(entry.Type) && arrayIndex < entry.Count);
+		memcpy(data.Data.data() + entry.Offset + arrayIndex * sizeof(VkDescriptorBufferInfo), &bufferInfo, sizeof(VkDescriptorBufferInfo));
+	}
 
-		}
+	void VulkanShader::UpdateDescriptorSet(VkDescriptorSet descriptorSet, const DescriptorSetData& data) const
+	{
+		XO_CORE_ASSERT(data.Set < m_ShaderDescriptorSets.size());
+		const ShaderDescriptorSet& shaderDescriptorSet = m_ShaderDescriptorSets[data.Set];
+		XO_CORE_ASSERT(data.Data.size() == shaderDescriptorSet.TemplateDataSize, "Descriptor data was created for a different version of the shader");
+		if (!shaderDescriptorSet.UpdateTemplate)
+			return;
 
-		XO_CORE_ASSERT(poolSizes.find(set) != poolSizes.end());
+		vkUpdateDescriptorSetWithTemplate(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), descriptorSet, shaderDescriptorSet.UpdateTemplate, data.Data.data());
+	}
 
-		// TODO: Move this to the centralized renderer
-		VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
-		descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		descriptorPoolInfo.pNext = nullptr;
-		descriptorPoolInfo.poolSizeCount = (uint32_t)poolSizes.at(set).size();
-		descriptorPoolInfo.pPoolSizes = poolSizes.at(set).data();
-		descriptorPoolInfo.maxSets = numberOfSets;
+	Xero::VulkanShader::ShaderMaterialDescriptorSet VulkanShader::CreateDescriptorSets(uint32_t set /*= 0*/)
+	{
+		return CreateDescriptorSets(set, 1);
+	}
 
-		VK_CHECK_RESULT(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &result.Pool));
+	Xero::VulkanShader::ShaderMaterialDescriptorSet VulkanShader::CreateDescriptorSets(uint32_t set, uint32_t numberOfSets)
+	{
+		XO_CORE_ASSERT(m_TypeCounts.find(set) != m_TypeCounts.end());
+		ShaderMaterialDescriptorSet result;
 
+		// Pools are owned by the renderer, material sets come from its long-lived allocator
+		result.Pool = nullptr;
 		result.DescriptorSets.resize(numberOfSets);
 
 		for (uint32_t i = 0; i < numberOfSets; i++)
 		{
-			VkDescriptorSetAllocateInfo allocInfo = {};
+			VkDescriptorSetAllocateInfo allocInfo{};
 			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			allocInfo.descriptorPool = result.Pool;
 			allocInfo.descriptorSetCount = 1;
 			allocInfo.pSetLayouts = &m_DescriptorSetLayouts[set];
 
-			VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, &result.DescriptorSets[i]));
+			result.DescriptorSets[i] = VulkanRenderer::RT_AllocateDescriptorSet(allocInfo, m_TypeCounts.at(set));
+			WriteUniformBufferDescriptors(result.DescriptorSets[i], set);
 		}
 		return result;
 	}
@@ -615,12 +1022,12 @@ namespace Xero {
 	Xero::VulkanShader::ShaderMaterialDescriptorSet VulkanShader::AllocateDescriptorSet(uint32_t set /*= 0*/)
 	{
 		XO_CORE_ASSERT(set < m_DescriptorSetLayouts.size());
+		XO_CORE_ASSERT(set != VulkanBindlessTable::DescriptorSetIndex || !VulkanRenderer::IsBindlessEnabled(), "Bind VulkanRenderer::GetBindlessTable() instead");
 		ShaderMaterialDescriptorSet result;
 
 		if (m_ShaderDescriptorSets.empty())
 			return result;
 
-		// TODO: Remove
 		result.Pool = nullptr;
 
 		VkDescriptorSetAllocateInfo allocInfo{};
@@ -628,23 +1035,64 @@ namespace Xero {
 		allocInfo.descriptorSetCount = 1;
 		allocInfo.pSetLayouts = &m_DescriptorSetLayouts[set];
 
-		//VkDescriptorSet descriptorSet = VulkanRenderer::RT_AllocateDescriptorSet(allocInfo);
-		//result.DescriptorSets.push_back(descriptorSet);
+		// Transient, recycled with the frame's pools
+		static const std::vector<VkDescriptorPoolSize> s_NoTypeCounts;
+		auto typeCounts = m_TypeCounts.find(set);
+		const auto& setSizes = typeCounts != m_TypeCounts.end() ? typeCounts->second : s_NoTypeCounts;
+		VkDescriptorSet descriptorSet = VulkanRenderer::RT_AllocateFrameDescriptorSet(allocInfo, setSizes);
+		WriteUniformBufferDescriptors(descriptorSet, set);
+		result.DescriptorSets.push_back(descriptorSet);
 
 		return result;
 	}
 
+	void VulkanShader::WriteUniformBufferDescriptors(VkDescriptorSet descriptorSet, uint32_t set)
+	{
+		if (set >= m_ShaderDescriptorSets.size())
+			return;
+
+		// Static for the lifetime of the set, updates only ever change the dynamic offset
+		std::vector<VkWriteDescriptorSet> writes;
+		for (const auto& descriptor : m_ShaderDescriptorSets[set].Descriptors)
+		{
+			if (descriptor.Write.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+				continue;
+
+			VkWriteDescriptorSet& write = writes.emplace_back(descriptor.Write);
+			write.dstSet = descriptorSet;
+		}
+
+		if (!writes.empty())
+			vkUpdateDescriptorSets(VulkanContext::GetCurrentDevice()->GetVulkanDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+	}
+
 	const VkWriteDescriptorSet* VulkanShader::GetDescriptorSet(const std::string& name, uint32_t set /*= 0*/) const
+	{
+		ShaderResourceHandle handle = GetResourceHandle(name, set);
+		return handle ? GetDescriptorSet(handle) : nullptr;
+	}
+
+	VulkanShader::ShaderResourceHandle VulkanShader::GetResourceHandle(const std::string& name, uint32_t set /*= 0*/) const
 	{
 		XO_CORE_ASSERT(set < m_ShaderDescriptorSets.size());
 		XO_CORE_ASSERT(m_ShaderDescriptorSets[set]);
-		if (m_ShaderDescriptorSets[set].WriteDescriptorSets.find(name) == m_ShaderDescriptorSets[set].WriteDescriptorSets.end())
+
+		uint32_t index = Utils::FindDescriptor(m_ShaderDescriptorSets[set], name);
+		if (index == UINT32_MAX)
 		{
-			XO_CORE_WARN("Shader {0} does not contain requested descriptor set {1}", m_Name, name);
-			return nullptr;
+			XO_CORE_WARN("Shader {0} does not contain requested descriptor {1}", m_Name, name);
+			return {};
 		}
 
-		return &m_ShaderDescriptorSets.at(set).WriteDescriptorSets.at(name);
+		return { set, index };
+	}
+
+	VulkanShader::UniformBuffer& VulkanShader::GetUniformBuffer(uint32_t binding /*= 0*/, uint32_t set /*= 0*/)
+	{
+		const auto& uniformBuffers = m_ShaderDescriptorSets.at(set).UniformBuffers;
+		auto it = Utils::FindBinding(uniformBuffers, binding);
+		XO_CORE_ASSERT(it != uniformBuffers.end());
+		return **it;
 	}
 
 	std::vector<VkDescriptorSetLayout> VulkanShader::GetAllDescriptorSetLayouts()
@@ -683,73 +1131,106 @@ namespace Xero {
 
 	void VulkanShader::CompileOrGetVulkanBinary(std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& outputBinary, bool forceCompile)
 	{
+		// Stages are independent, fan them out and join before reflection
+		std::vector<std::pair<VkShaderStageFlagBits, std::future<std::vector<uint32_t>>>> jobs;
+		jobs.reserve(m_ShaderSource.size());
+		for (const auto& [stage, source] : m_ShaderSource)
+		{
+			VkShaderStageFlagBits shaderStage = stage;
+			jobs.emplace_back(shaderStage, ThreadPool::Get().Submit([this, shaderStage, forceCompile]() { return CompileOrGetStageBinary(shaderStage, forceCompile); }));
+		}
+
+		for (auto& [stage, job] : jobs)
+			outputBinary[stage] = job.get();
+	}
+
+	uint32_t VulkanShader::GetStageHash(VkShaderStageFlagBits stage) const
+	{
+		// Cache entries are keyed on everything that goes into the compiler, not on the file name alone
+		return Hash::GenerateFNVHash(fmt::format("{}|{}|{}", (uint32_t)stage, Utils::GetCompileOptionsKey(), m_ShaderSource.at(stage)));
+	}
+
+	std::vector<uint32_t> VulkanShader::CompileOrGetStageBinary(VkShaderStageFlagBits stage, bool forceCompile) const
+	{
+		std::vector<uint32_t> result;
+
 		std::filesystem::path cacheDirectory = Utils::GetCacheDirectory();
-		for (auto [stage, source] : m_ShaderSource)
+		std::filesystem::path assetPath = m_AssetPath;
+		std::string cacheKey = assetPath.filename().string() + VkShaderStageCachedFileExtension(stage);
+		std::string cachedFilePath = (cacheDirectory / cacheKey).string();
+
+		const auto& shaderSource = m_ShaderSource.at(stage);
+		uint32_t hash = GetStageHash(stage);
+
+		ShaderCache& shaderCache = Utils::GetShaderCache();
+		if (!forceCompile && !shaderCache.HasChanged(cacheKey, hash))
 		{
-			auto extension = VkShaderStageCachedFileExtension(stage);
-			if (!forceCompile)
+			FILE* f;
+			errno_t err = fopen_s(&f, cachedFilePath.c_str(), "rb");
+			if (!err)
 			{
-				std::filesystem::path p = m_AssetPath;
-				auto path = cacheDirectory / (p.filename().string() + extension);
-				std::string cachedFilePath = path.string();
+				fseek(f, 0, SEEK_END);
+				uint64_t size = ftell(f);
+				fseek(f, 0, SEEK_SET);
+				result = std::vector<uint32_t>(size / sizeof(uint32_t));
+				fread(result.data(), sizeof(uint32_t), result.size(), f);
+				fclose(f);
+			}
+		}
 
-				FILE* f;
-				errno_t err = fopen_s(&f, cachedFilePath.c_str(), "rb");
-				if (!err)
+		if (result.size() == 0)
+		{
+			XO_CORE_TRACE("Compiling {0} ({1:x})", cacheKey, hash);
+
+			// shaderc compilers are expensive to create, keep one per thread
+			static thread_local shaderc::Compiler compiler;
+
+			// Compile Shader
+			{
+				shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(shaderSource, VkShaderStageToShaderC(stage), m_AssetPath.c_str(), Utils::GetCompileOptions());
+
+				// Failures are reported to the caller, a hot reload has to survive a typo
+				if (module.GetCompilationStatus() != shaderc_compilation_status_success)
 				{
-					fseek(f, 0, SEEK_END);
-					uint64_t size = ftell(f);
-					fseek(f, 0, SEEK_SET);
-					outputBinary[stage] = std::vector<uint32_t>(size / sizeof(uint32_t));
-					fread(outputBinary[stage].data(), sizeof(uint32_t), outputBinary[stage].size(), f);
-					fclose(f);
+					XO_CORE_ERROR(module.GetErrorMessage());
+					return {};
 				}
+
+				result = std::vector<uint32_t>(module.cbegin(), module.cend());
 			}
 
-			if (outputBinary[stage].size() == 0)
+			// Cache Compiled Shader
 			{
-				// TODO: This is kinda sketch
-				shaderc::Compiler compiler;
-				shaderc::CompileOptions options;
-				options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
-				options.SetWarningsAsErrors();
-				options.SetGenerateDebugInfo();
-
-				#if OPTIMIZE_COMPILER
-				options.SetOptimizationLevel(shaderc_optimization_level_performance);
-				#endif
+				// Written next to the cached file and renamed over it, a reader never sees a partial binary under a matching hash
+				std::string tempFilePath = cachedFilePath + ".tmp";
+				bool written = false;
 
-				// Compile Shader
+				FILE* f;
+				errno_t err = fopen_s(&f, tempFilePath.c_str(), "wb");
+				if (!err)
 				{
-					auto& shaderSource = m_ShaderSource[stage];
-					shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(shaderSource, VkShaderStageToShaderC(stage), m_AssetPath.c_str(), options);
-
-					if (module.GetCompilationStatus() != shaderc_compilation_status_success)
-					{
-						XO_CORE_ERROR(module.GetErrorMessage());
-						XO_CORE_ASSERT(false);
-					}
+					written = fwrite(result.data(), sizeof(uint32_t), result.size(), f) == result.size();
+					written &= fclose(f) == 0;
+				}
 
-					const uint8_t* begin = (const uint8_t*)module.cbegin();
-					const uint8_t* end = (const uint8_t*)module.cend();
-					const ptrdiff_t size = end - begin;
+				std::error_code error;
+				if (written)
+					std::filesystem::rename(tempFilePath, cachedFilePath, error);
 
-					outputBinary[stage] = std::vector<uint32_t>(module.cbegin(), module.cend());
+				if (written && !error)
+				{
+					shaderCache.Update(cacheKey, hash);
 				}
-
-				// Cache Compiled Shader
+				else
 				{
-					std::filesystem::path p = m_AssetPath;
-					auto path = cacheDirectory / (p.filename().string() + extension);
-					std::string cachedFilePath = path.string();
-
-					FILE* f;
-					fopen_s(&f, cachedFilePath.c_str(), "wb");
-					fwrite(outputBinary[stage].data(), sizeof(uint32_t), outputBinary[stage].size(), f);
-					fclose(f);
+					XO_CORE_ERROR("Could not write shader cache file {0}", cachedFilePath);
+					std::filesystem::remove(tempFilePath, error);
+					shaderCache.Invalidate(cacheKey);
 				}
 			}
 		}
+
+		return result;
 	}
 
 	static VkShaderStageFlagBits ShaderTypeFromString(const std::string& type)
@@ -785,9 +1266,301 @@ namespace Xero {
 		return shaderSources;
 	}
 
-	void VulkanShader::AddShaderReloadedCallback(const ShaderReloadedCallback& callback)
+	//////////////////////////////////////////////////////////////////////////////////
+	// Reflection Cache
+	//////////////////////////////////////////////////////////////////////////////////
+
+	namespace Utils {
+
+		static constexpr uint32_t s_ReflectionCacheMagic = 0x46455258; // "XREF"
+		static constexpr uint32_t s_ReflectionCacheVersion = 2;
+
+		template<typename T>
+		static void WriteRaw(std::ofstream& out, const T& value)
+		{
+			out.write((const char*)&value, sizeof(T));
+		}
+
+		static void WriteString(std::ofstream& out, const std::string& string)
+		{
+			WriteRaw<uint32_t>(out, (uint32_t)string.size());
+			out.write(string.data(), string.size());
+		}
+
+		template<typename T>
+		static bool ReadRaw(std::ifstream& in, T& value)
+		{
+			return (bool)in.read((char*)&value, sizeof(T));
+		}
+
+		// Counts and lengths come from disk, one the rest of the file could not hold means the file is corrupt
+		static bool FitsInFile(std::ifstream& in, uint64_t fileSize, uint64_t size)
+		{
+			std::streamoff position = in.tellg();
+			return position >= 0 && (uint64_t)position <= fileSize && size <= fileSize - (uint64_t)position;
+		}
+
+		// Every record is at least one uint32_t, so a count can never exceed a quarter of the remaining bytes
+		static bool ReadCount(std::ifstream& in, uint32_t& count, uint64_t fileSize)
+		{
+			return ReadRaw(in, count) && FitsInFile(in, fileSize, (uint64_t)count * sizeof(uint32_t));
+		}
+
+		static bool ReadString(std::ifstream& in, std::string& string, uint64_t fileSize)
+		{
+			uint32_t size;
+			if (!ReadRaw(in, size) || !FitsInFile(in, fileSize, size))
+				return false;
+
+			string.resize(size);
+			return (bool)in.read(string.data(), size);
+		}
+
+	}
+
+	std::string VulkanShader::GetReflectionCacheKey() const
+	{
+		return std::filesystem::path(m_AssetPath).filename().string() + ".cached_vulkan.refl";
+	}
+
+	uint32_t VulkanShader::GetReflectionHash() const
+	{
+		// Reflection is valid for exactly the inputs the stage binaries were built from
+		std::vector<VkShaderStageFlagBits> stages;
+		for (const auto& [stage, source] : m_ShaderSource)
+			stages.push_back(stage);
+		std::sort(stages.begin(), stages.end());
+
+		std::string key = fmt::format("refl{}", Utils::s_ReflectionCacheVersion);
+		for (VkShaderStageFlagBits stage : stages)
+			key += fmt::format("|{}:{:x}", (uint32_t)stage, GetStageHash(stage));
+
+		return Hash::GenerateFNVHash(key);
+	}
+
+	void VulkanShader::SerializeReflectionData()
+	{
+		std::string cacheKey = GetReflectionCacheKey();
+		std::filesystem::path path = std::filesystem::path(Utils::GetCacheDirectory()) / cacheKey;
+		uint32_t hash = GetReflectionHash();
+
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			XO_CORE_ERROR("Could not write reflection cache {0}", path.string());
+			Utils::GetShaderCache().Invalidate(cacheKey);
+			return;
+		}
+
+		Utils::WriteRaw(out, Utils::s_ReflectionCacheMagic);
+		Utils::WriteRaw(out, Utils::s_ReflectionCacheVersion);
+		Utils::WriteRaw(out, hash);
+
+		auto writeBuffers = [&out](const std::vector<ReflectedBuffer>& buffers, uint32_t set)
+		{
+			uint32_t count = (uint32_t)std::count_if(buffers.begin(), buffers.end(), [set](const ReflectedBuffer& buffer) { return buffer.Set == set; });
+			Utils::WriteRaw(out, count);
+			for (const auto& buffer : buffers)
+			{
+				if (buffer.Set != set)
+					continue;
+
+				Utils::WriteRaw(out, buffer.Binding);
+				Utils::WriteRaw(out, buffer.Size);
+				Utils::WriteString(out, buffer.Name);
+			}
+		};
+
+		Utils::WriteRaw<uint32_t>(out, (uint32_t)m_ShaderDescriptorSets.size());
+		for (uint32_t set = 0; set < (uint32_t)m_ShaderDescriptorSets.size(); set++)
+		{
+			const auto& shaderDescriptorSet = m_ShaderDescriptorSets[set];
+			writeBuffers(m_ReflectedUniformBuffers, set);
+			writeBuffers(m_ReflectedStorageBuffers, set);
+
+			Utils::WriteRaw<uint32_t>(out, (uint32_t)shaderDescriptorSet.ImageSamplers.size());
+			for (const auto& imageSampler : shaderDescriptorSet.ImageSamplers)
+			{
+				Utils::WriteRaw(out, imageSampler.BindingPoint);
+				Utils::WriteRaw(out, imageSampler.ArraySize);
+				Utils::WriteRaw(out, imageSampler.ShaderStage);
+				Utils::WriteString(out, imageSampler.Name);
+			}
+
+			Utils::WriteRaw<uint32_t>(out, (uint32_t)shaderDescriptorSet.StorageImages.size());
+			for (const auto& storageImage : shaderDescriptorSet.StorageImages)
+			{
+				Utils::WriteRaw(out, storageImage.BindingPoint);
+				Utils::WriteRaw(out, storageImage.ShaderStage);
+				Utils::WriteString(out, storageImage.Name);
+			}
+		}
+
+		Utils::WriteRaw<uint32_t>(out, (uint32_t)m_PushConstantRanges.size());
+		for (const auto& pushConstantRange : m_PushConstantRanges)
+		{
+			Utils::WriteRaw(out, pushConstantRange.ShaderStage);
+			Utils::WriteRaw(out, pushConstantRange.Offset);
+			Utils::WriteRaw(out, pushConstantRange.Size);
+		}
+
+		Utils::WriteRaw<uint32_t>(out, (uint32_t)m_Buffers.size());
+		for (const auto& [name, buffer] : m_Buffers)
+		{
+			Utils::WriteString(out, buffer.Name);
+			Utils::WriteRaw(out, buffer.Size);
+			Utils::WriteRaw<uint32_t>(out, (uint32_t)buffer.Uniforms.size());
+			for (const auto& [uniformName, uniform] : buffer.Uniforms)
+			{
+				Utils::WriteString(out, uniform.GetName());
+				Utils::WriteRaw(out, uniform.GetType());
+				Utils::WriteRaw(out, uniform.GetSize());
+				Utils::WriteRaw(out, uniform.GetOffset());
+			}
+		}
+
+		Utils::WriteRaw<uint32_t>(out, (uint32_t)m_Resources.size());
+		for (const auto& [name, resource] : m_Resources)
+		{
+			Utils::WriteString(out, resource.GetName());
+			Utils::WriteRaw(out, resource.GetRegister());
+			Utils::WriteRaw(out, resource.GetCount());
+		}
+
+		out.close();
+		Utils::GetShaderCache().Update(cacheKey, hash);
+	}
+
+	bool VulkanShader::TryReadReflectionData()
 	{
+		std::string cacheKey = GetReflectionCacheKey();
+		uint32_t hash = GetReflectionHash();
+		if (Utils::GetShaderCache().HasChanged(cacheKey, hash))
+			return false;
+
+		std::filesystem::path path = std::filesystem::path(Utils::GetCacheDirectory()) / cacheKey;
+		std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!in)
+			return false;
+
+		uint64_t fileSize = (uint64_t)in.tellg();
+		in.seekg(0, std::ios::beg);
+
+		uint32_t magic = 0, version = 0, fileHash = 0;
+		Utils::ReadRaw(in, magic);
+		Utils::ReadRaw(in, version);
+		Utils::ReadRaw(in, fileHash);
+		if (magic != Utils::s_ReflectionCacheMagic || version != Utils::s_ReflectionCacheVersion || fileHash != hash)
+			return false;
+
+		// Read into locals first so a truncated file leaves no partial state behind
+		std::vector<ReflectedBuffer> uniformBuffers, storageBuffers;
+		std::vector<ShaderDescriptorSet> shaderDescriptorSets;
+		std::vector<PushConstantRange> pushConstantRanges;
+		std::unordered_map<std::string, ShaderBuffer> buffers;
+		std::unordered_map<std::string, ShaderResourceDeclaration> resources;
+
+		bool valid = true;
+		uint32_t setCount = 0;
+		valid &= Utils::ReadCount(in, setCount, fileSize);
+		shaderDescriptorSets.resize(valid ? setCount : 0);
+		for (uint32_t set = 0; valid && set < setCount; set++)
+		{
+			ShaderDescriptorSet& shaderDescriptorSet = shaderDescriptorSets[set];
+
+			uint32_t count = 0;
+			valid &= Utils::ReadCount(in, count, fileSize);
+			for (uint32_t i = 0; valid && i < count; i++)
+			{
+				ReflectedBuffer& record = uniformBuffers.emplace_back();
+				record.Set = set;
+				valid &= Utils::ReadRaw(in, record.Binding) && Utils::ReadRaw(in, record.Size) && Utils::ReadString(in, record.Name, fileSize);
+			}
+
+			valid &= Utils::ReadCount(in, count, fileSize);
+			for (uint32_t i = 0; valid && i < count; i++)
+			{
+				ReflectedBuffer& record = storageBuffers.emplace_back();
+				record.Set = set;
+				valid &= Utils::ReadRaw(in, record.Binding) && Utils::ReadRaw(in, record.Size) && Utils::ReadString(in, record.Name, fileSize);
+			}
 
+			valid &= Utils::ReadCount(in, count, fileSize);
+			for (uint32_t i = 0; valid && i < count; i++)
+			{
+				ImageSampler imageSampler;
+				imageSampler.DescriptorSet = set;
+				valid &= Utils::ReadRaw(in, imageSampler.BindingPoint) && Utils::ReadRaw(in, imageSampler.ArraySize) && Utils::ReadRaw(in, imageSampler.ShaderStage) && Utils::ReadString(in, imageSampler.Name, fileSize);
+				Utils::SetBinding(shaderDescriptorSet.ImageSamplers, imageSampler);
+			}
+
+			valid &= Utils::ReadCount(in, count, fileSize);
+			for (uint32_t i = 0; valid && i < count; i++)
+			{
+				ImageSampler storageImage;
+				storageImage.DescriptorSet = set;
+				valid &= Utils::ReadRaw(in, storageImage.BindingPoint) && Utils::ReadRaw(in, storageImage.ShaderStage) && Utils::ReadString(in, storageImage.Name, fileSize);
+				Utils::SetBinding(shaderDescriptorSet.StorageImages, storageImage);
+			}
+		}
+
+		uint32_t pushConstantCount = 0;
+		valid &= Utils::ReadCount(in, pushConstantCount, fileSize);
+		for (uint32_t i = 0; valid && i < pushConstantCount; i++)
+		{
+			PushConstantRange& range = pushConstantRanges.emplace_back();
+			valid &= Utils::ReadRaw(in, range.ShaderStage) && Utils::ReadRaw(in, range.Offset) && Utils::ReadRaw(in, range.Size);
+		}
+
+		uint32_t bufferCount = 0;
+		valid &= Utils::ReadCount(in, bufferCount, fileSize);
+		for (uint32_t i = 0; valid && i < bufferCount; i++)
+		{
+			ShaderBuffer buffer;
+			uint32_t uniformCount = 0;
+			valid &= Utils::ReadString(in, buffer.Name, fileSize) && Utils::ReadRaw(in, buffer.Size) && Utils::ReadCount(in, uniformCount, fileSize);
+			for (uint32_t j = 0; valid && j < uniformCount; j++)
+			{
+				std::string name;
+				ShaderUniformType type;
+				uint32_t size, offset;
+				valid &= Utils::ReadString(in, name, fileSize) && Utils::ReadRaw(in, type) && Utils::ReadRaw(in, size) && Utils::ReadRaw(in, offset);
+				buffer.Uniforms[name] = ShaderUniform(name, type, size, offset);
+			}
+			buffers[buffer.Name] = buffer;
+		}
+
+		uint32_t resourceCount = 0;
+		valid &= Utils::ReadCount(in, resourceCount, fileSize);
+		for (uint32_t i = 0; valid && i < resourceCount; i++)
+		{
+			std::string name;
+			uint32_t resourceRegister, count;
+			valid &= Utils::ReadString(in, name, fileSize) && Utils::ReadRaw(in, resourceRegister) && Utils::ReadRaw(in, count);
+			resources[name] = ShaderResourceDeclaration(name, resourceRegister, count);
+		}
+
+		if (!valid)
+		{
+			XO_CORE_WARN("Reflection cache {0} is corrupt, reflecting from SPIR-V", path.string());
+			return false;
+		}
+
+		// Registered with the shared buffer registry by Finalize, the same as live reflection
+		m_ReflectedUniformBuffers = std::move(uniformBuffers);
+		m_ReflectedStorageBuffers = std::move(storageBuffers);
+		m_ShaderDescriptorSets = std::move(shaderDescriptorSets);
+		m_PushConstantRanges = std::move(pushConstantRanges);
+		m_Buffers = std::move(buffers);
+		m_Resources = std::move(resources);
+
+		XO_CORE_TRACE("Loaded reflection data for {0} from cache", m_Name);
+		return true;
+	}
+
+	void VulkanShader::AddShaderReloadedCallback(const ShaderReloadedCallback& callback)
+	{
+		m_ReloadedCallbacks.push_back(callback);
 	}
 
 }
\ No newline at end of file
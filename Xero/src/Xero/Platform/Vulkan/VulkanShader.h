@@ -2,6 +2,8 @@
 
 #include "Xero/Renderer/Shader.h"
 
+#include <future>
+
 #include "Vulkan.h"
 #include "vma/vk_mem_alloc.h"
 
@@ -38,6 +40,15 @@ namespace Xero {
 			VkShaderStageFlagBits ShaderStage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
 		};
 
+		// Where a named binding lives in the packed data of its set's update template
+		struct DescriptorTemplateEntry
+		{
+			uint32_t Binding = 0;
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+			VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		};
+
 		struct PushConstantRange
 		{
 			VkShaderStageFlagBits ShaderStage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
@@ -51,7 +62,12 @@ namespace Xero {
 
 		virtual void Reload(bool forceCompile = false) override;
 
+		// Recompiles on the worker pool, the result is swapped in by ProcessHotReload at the next frame boundary
+		void ReloadAsync(bool forceCompile = false);
+
 		virtual size_t GetHash() const override;
+		// Changes whenever the compiled code does, pipelines built from an older version are stale
+		uint32_t GetContentHash() const { return m_ContentHash; }
 
 		virtual const std::string& GetName() const override { return m_Name; }
 		virtual const std::unordered_map<std::string, ShaderBuffer>& GetShaderBuffers() const override { return m_Buffers; }
@@ -66,7 +82,7 @@ namespace Xero {
 		VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t set) { return m_DescriptorSetLayouts.at(set); }
 		std::vector<VkDescriptorSetLayout> GetAllDescriptorSetLayouts();
 
-		UniformBuffer& GetUniformBuffer(uint32_t binding = 0, uint32_t set = 0) { XO_CORE_ASSERT(m_ShaderDescriptorSets.at(set).UniformBuffers.size() > binding); return *m_ShaderDescriptorSets.at(set).UniformBuffers.at(binding); }
+		UniformBuffer& GetUniformBuffer(uint32_t binding = 0, uint32_t set = 0);
 		uint32_t GetUniformBufferCount(uint32_t set = 0)
 		{
 			if (m_ShaderDescriptorSets.size() < set)
@@ -75,50 +91,141 @@ namespace Xero {
 			return (uint32_t)m_ShaderDescriptorSets[set].UniformBuffers.size();
 		}
 
+		// One binding of a set, resolved from its name once through GetResourceHandle
+		struct ShaderDescriptor
+		{
+			std::string Name;
+			uint32_t NameHash = 0;
+			uint32_t Binding = 0;
+			VkWriteDescriptorSet Write{};
+			DescriptorTemplateEntry TemplateEntry;
+		};
+
+		// Reflection tables, each sorted by binding
 		struct ShaderDescriptorSet
 		{
-			std::unordered_map<uint32_t, UniformBuffer*> UniformBuffers;
-			std::unordered_map<uint32_t, StorageBuffer*> StorageBuffers;
-			std::unordered_map<uint32_t, ImageSampler> ImageSamplers;
-			std::unordered_map<uint32_t, ImageSampler> StorageImages;
+			std::vector<UniformBuffer*> UniformBuffers;
+			std::vector<StorageBuffer*> StorageBuffers;
+			std::vector<ImageSampler> ImageSamplers;
+			std::vector<ImageSampler> StorageImages;
 
-			std::unordered_map<std::string, VkWriteDescriptorSet> WriteDescriptorSets;
+			// Every binding of the set, a ShaderResourceHandle indexes in here
+			std::vector<ShaderDescriptor> Descriptors;
+
+			// Writes every binding of the set in one call, the data is laid out as described by the descriptors' template entries
+			VkDescriptorUpdateTemplate UpdateTemplate = VK_NULL_HANDLE;
+			uint32_t TemplateDataSize = 0;
 
 			operator bool() const { return !(StorageBuffers.empty() && UniformBuffers.empty() && ImageSamplers.empty() && StorageImages.empty()); }
 		};
 		const std::vector<ShaderDescriptorSet>& GetShaderDescriptorSets() const { return m_ShaderDescriptorSets; }
+		// Uniform buffers are dynamic; bind with one offset from VulkanRenderer::GetUniformBufferRing() per uniform buffer, in binding order
+		uint32_t GetDynamicOffsetCount(uint32_t set = 0) const { return set < m_ShaderDescriptorSets.size() ? (uint32_t)m_ShaderDescriptorSets[set].UniformBuffers.size() : 0; }
 		bool HasDescriptorSet(uint32_t set) const { return m_TypeCounts.find(set) != m_TypeCounts.end(); }
 
 		const std::vector<PushConstantRange>& GetPushConstantRanges() const { return m_PushConstantRanges; }
 
 		struct ShaderMaterialDescriptorSet
 		{
-			VkDescriptorPool Pool = nullptr;
+			VkDescriptorPool Pool = nullptr; // Unused, sets are allocated from the renderer's pools
 			std::vector<VkDescriptorSet> DescriptorSets;
 		};
 
+		// Valid for the current frame only
 		ShaderMaterialDescriptorSet AllocateDescriptorSet(uint32_t set = 0);
+		// Long-lived, for materials
 		ShaderMaterialDescriptorSet CreateDescriptorSets(uint32_t set = 0);
 		ShaderMaterialDescriptorSet CreateDescriptorSets(uint32_t set, uint32_t numberOfSets);
 		const VkWriteDescriptorSet* GetDescriptorSet(const std::string& name, uint32_t set = 0) const;
 
+		// Addresses a descriptor without any lookup. Resolve it once, e.g. when a material is created; it is invalidated
+		// when the shader is reloaded
+		struct ShaderResourceHandle
+		{
+			uint32_t Set = 0;
+			uint32_t Index = UINT32_MAX;
+
+			explicit operator bool() const { return Index != UINT32_MAX; }
+		};
+
+		ShaderResourceHandle GetResourceHandle(const std::string& name, uint32_t set = 0) const;
+		const ShaderDescriptor& GetDescriptor(ShaderResourceHandle handle) const { return m_ShaderDescriptorSets[handle.Set].Descriptors[handle.Index]; }
+		const VkWriteDescriptorSet* GetDescriptorSet(ShaderResourceHandle handle) const { return &GetDescriptor(handle).Write; }
+
+		// Packed descriptor infos for one set in the layout of its update template. Materials keep one per set, resolve
+		// their entries once and rewrite the set with a single UpdateDescriptorSet call. Every binding has to be filled
+		// before the first update; the data has to be recreated when the shader is reloaded
+		struct DescriptorSetData
+		{
+			uint32_t Set = 0;
+			std::vector<uint8_t> Data;
+		};
+
+		// Uniform buffers come pre-filled
+		DescriptorSetData CreateDescriptorSetData(uint32_t set = 0) const;
+		const DescriptorTemplateEntry* GetDescriptorTemplateEntry(const std::string& name, uint32_t set = 0) const;
+		const DescriptorTemplateEntry& GetDescriptorTemplateEntry(ShaderResourceHandle handle) const { return GetDescriptor(handle).TemplateEntry; }
+		static void SetImage(DescriptorSetData& data, const DescriptorTemplateEntry& entry, const VkDescriptorImageInfo& imageInfo, uint32_t arrayIndex = 0);
+		static void SetBuffer(DescriptorSetData& data, const DescriptorTemplateEntry& entry, const VkDescriptorBufferInfo& bufferInfo, uint32_t arrayIndex = 0);
+		void UpdateDescriptorSet(VkDescriptorSet descriptorSet, const DescriptorSetData& data) const;
+
 		static void ClearUniformBuffers();
+
+		// Compiles all shaders on the worker pool, reflection and module creation are joined on the calling thread
+		static std::vector<Ref<Shader>> CreateBatch(const std::vector<std::string>& paths, bool forceCompile);
+
+		// Must be called at a frame boundary, queues reloads for changed sources and swaps in finished ones
+		static void ProcessHotReload();
 	private:
+		VulkanShader(const std::string& path);
+
+		// Compile and ReflectShaderData touch no device or shared state and may run on a worker.
+		// Finalize creates the modules, registers the buffers and creates the descriptors on the main thread
+		bool Compile(bool forceCompile);
+		void ReflectShaderData(bool forceCompile);
+		void Finalize();
+
+		void WatchForChanges();
+		void SwapShaderData(VulkanShader& other);
+		void DestroyShaderModules();
+
 		std::unordered_map<VkShaderStageFlagBits, std::string> PreProcess(const std::string& source);
 		void CompileOrGetVulkanBinary(std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& outputBinary, bool forceCompile);
+		std::vector<uint32_t> CompileOrGetStageBinary(VkShaderStageFlagBits stage, bool forceCompile) const;
+		uint32_t GetStageHash(VkShaderStageFlagBits stage) const;
 		void LoadAndCreateShaders(const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& shaderData);
 		void Reflect(VkShaderStageFlagBits shaderStage, const std::vector<uint32_t>& shaderData);
 		void ReflectAllShaderStages(const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& shaderData);
 
+		struct ReflectedBuffer
+		{
+			uint32_t Set = 0;
+			uint32_t Binding = 0;
+			uint32_t Size = 0;
+			std::string Name;
+		};
+		static void AddReflectedBuffer(std::vector<ReflectedBuffer>& buffers, const ReflectedBuffer& buffer);
+
+		std::string GetReflectionCacheKey() const;
+		uint32_t GetReflectionHash() const;
+		void SerializeReflectionData();
+		bool TryReadReflectionData();
+
 		void CreateDescriptors();
+		void DestroyDescriptorUpdateTemplates();
+		void WriteUniformBufferDescriptors(VkDescriptorSet descriptorSet, uint32_t set);
 
 	private:
 		std::vector<VkPipelineShaderStageCreateInfo> m_PipelineShaderStageCreateInfos;
 		std::unordered_map<VkShaderStageFlagBits, std::string> m_ShaderSource;
+		std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> m_ShaderData; // Compiled but not yet finalized
 		std::string m_AssetPath;
 		std::string m_Name;
 
 		std::vector<ShaderDescriptorSet> m_ShaderDescriptorSets;
+		// Buffers this shader declares, the descriptor sets point into the shared registry once finalized
+		std::vector<ReflectedBuffer> m_ReflectedUniformBuffers;
+		std::vector<ReflectedBuffer> m_ReflectedStorageBuffers;
 
 		std::vector<PushConstantRange> m_PushConstantRanges;
 		std::unordered_map<std::string, ShaderResourceDeclaration> m_Resources;
@@ -129,6 +236,13 @@ namespace Xero {
 		VkDescriptorSet m_DescriptorSet;
 
 		std::unordered_map<uint32_t, std::vector<VkDescriptorPoolSize>> m_TypeCounts;
+		uint32_t m_ContentHash = 0;
+
+		// Hot reload
+		std::future<VulkanShader*> m_PendingReload; // Fully built replacement, nullptr if compilation failed
+		bool m_ReloadQueued = false;
+		bool m_Watched = false;
+		std::vector<ShaderReloadedCallback> m_ReloadedCallbacks;
 	};
 
 }
\ No newline at end of file
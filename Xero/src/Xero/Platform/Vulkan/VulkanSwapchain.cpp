@@ -1,8 +1,15 @@
 #include "xopch.h"
 #include "VulkanSwapchain.h"
 
+#include "VulkanRenderer.h"
+
+#include "Xero/Renderer/Renderer.h"
+
 #include <GLFW/glfw3.h>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
 #define GET_INSTANCE_PROC_ADDR(inst, entrypoint)															\
 {																											\
 	fp##entrypoint = reinterpret_cast<PFN_vk##entrypoint>(vkGetInstanceProcAddr(inst, "vk"#entrypoint));	\
@@ -108,7 +115,19 @@ namespace Xero {
 		FindImageFormatAndColorSpace();
 	}
 
-	void VulkanSwapchain::Create(uint32_t* width, uint32_t* height, bool vsync /*= false*/)
+	void VulkanSwapchain::InitHeadless(const Ref<VulkanDevice>& device)
+	{
+		m_Device = device;
+		m_Headless = true;
+
+		m_QueueNodeIndex = (uint32_t)m_Device->GetPhysicalDevice()->GetQueueFamilyIndices().Graphics;
+
+		// Matches the usual surface format in size and can be written out without a swizzle
+		m_ColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+		m_ColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+	}
+
+	void VulkanSwapchain::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
 	{
 		VkDevice device = m_Device->GetVulkanDevice();
 		VkPhysicalDevice physicalDevice = m_Device->GetPhysicalDevice()->GetVulkanPhysicalDevice();
@@ -238,15 +257,20 @@ namespace Xero {
 
 		VK_CHECK_RESULT(fpCreateSwapchainKHR(device, &swapchainCI, nullptr, &m_Swapchain));
 
-		// If an existing swap chain is re-created, destroy the old swap chain
+		// If an existing swap chain is re-created, retire the old swap chain once the frames presenting from it are done
 		// This also cleans up all the presentable images
 		if (oldSwapchain != VK_NULL_HANDLE)
 		{
+			std::vector<VkImageView> oldViews;
 			for (uint32_t i = 0; i < m_ImageCount; i++)
+				oldViews.push_back(m_Buffers[i].View);
+
+			VulkanRenderer::SubmitResourceFree([device, oldSwapchain, oldViews]()
 			{
-				vkDestroyImageView(device, m_Buffers[i].View, nullptr);
-			}
-			fpDestroySwapchainKHR(device, oldSwapchain, nullptr);
+				for (VkImageView view : oldViews)
+					vkDestroyImageView(device, view, nullptr);
+				fpDestroySwapchainKHR(device, oldSwapchain, nullptr);
+			});
 		}
 		VK_CHECK_RESULT(fpGetSwapchainImagesKHR(device, m_Swapchain, &m_ImageCount, NULL));
 
@@ -282,43 +306,24 @@ namespace Xero {
 
 			VK_CHECK_RESULT(vkCreateImageView(device, &colorAttachmentView, nullptr, &m_Buffers[i].View));
 		}
+	}
+
+	void VulkanSwapchain::Create(uint32_t* width, uint32_t* height, bool vsync /*= false*/)
+	{
+		if (m_Headless)
+		{
+			m_Width = *width;
+			m_Height = *height;
+			CreateOffscreenImages();
+		}
+		else
+		{
+			CreateSwapchain(width, height, vsync);
+		}
 
 		CreateDrawBuffers();
 
-		/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// Synchronization Objects
-		/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		VkSemaphoreCreateInfo semaphoreCreateInfo{};
-		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-		// Create a semaphore used to synchronize image presentation
-		// Ensures that the image is displayed before we start submitting new commands to the queu
-		VK_CHECK_RESULT(vkCreateSemaphore(m_Device->GetVulkanDevice(), &semaphoreCreateInfo, nullptr, &m_Semaphores.PresentComplete));
-		// Create a semaphore used to synchronize command submission
-		// Ensures that the image is not presented until all commands have been sumbitted and executed
-		VK_CHECK_RESULT(vkCreateSemaphore(m_Device->GetVulkanDevice(), &semaphoreCreateInfo, nullptr, &m_Semaphores.RenderComplete));
-
-		// Set up submit info structure
-		// Semaphores will stay the same during application lifetime
-		// Command buffer submission info is set by each example
-		VkPipelineStageFlags pipelineStageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-
-		m_SubmitInfo = {};
-		m_SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		m_SubmitInfo.pWaitDstStageMask = &pipelineStageFlags;
-		m_SubmitInfo.waitSemaphoreCount = 1;
-		m_SubmitInfo.pWaitSemaphores = &m_Semaphores.PresentComplete;
-		m_SubmitInfo.signalSemaphoreCount = 1;
-		m_SubmitInfo.pSignalSemaphores = &m_Semaphores.RenderComplete;
-
-		// Wait fences to sync command buffer access
-		VkFenceCreateInfo fenceCreateInfo{};
-		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-		m_WaitFences.resize(m_DrawCommandBuffers.size());
-		for (auto& fence : m_WaitFences)
-		{
-			VK_CHECK_RESULT(vkCreateFence(m_Device->GetVulkanDevice(), &fenceCreateInfo, nullptr, &fence));
-		}
+		CreateSyncObjects();
 
 		CreateDepthStencil();
 
@@ -334,7 +339,8 @@ namespace Xero {
 		attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		// Offscreen images are left ready to be read back
+		attachments[0].finalLayout = m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 		// Depth attachment
 		attachments[1].format = depthFormat;
 		attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
@@ -364,13 +370,20 @@ namespace Xero {
 		subpassDescription.pPreserveAttachments = nullptr;
 		subpassDescription.pResolveAttachments = nullptr;
 
-		VkSubpassDependency dependency = {};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		std::array<VkSubpassDependency, 2> dependencies = {};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].srcAccessMask = 0;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		// Offscreen images are read back by Capture, the writes and the final layout transition have to land before it
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
 		VkRenderPassCreateInfo renderPassInfo = {};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -378,10 +391,12 @@ namespace Xero {
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpassDescription;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		renderPassInfo.dependencyCount = m_Headless ? 2 : 1;
+		renderPassInfo.pDependencies = dependencies.data();
 
-		VK_CHECK_RESULT(vkCreateRenderPass(m_Device->GetVulkanDevice(), &renderPassInfo, nullptr, &m_RenderPass));
+		// Formats do not change on resize, keeping the render pass keeps cached pipelines valid
+		if (m_RenderPass == VK_NULL_HANDLE)
+			VK_CHECK_RESULT(vkCreateRenderPass(m_Device->GetVulkanDevice(), &renderPassInfo, nullptr, &m_RenderPass));
 
 		CreateFramebuffer();
 	}
@@ -389,42 +404,45 @@ namespace Xero {
 	void VulkanSwapchain::OnResize(uint32_t width, uint32_t height)
 	{
 		XO_CORE_WARN("VulkanContext::OnResize");
-		auto device = m_Device->GetVulkanDevice();
-
-		vkDeviceWaitIdle(device);
 
+		// No device wait, frames in flight keep their framebuffers and views until the deletion queue retires them.
+		// Draw command buffers are re-recorded every frame so they survive as they are
 		Create(&width, &height);
-		// Recreate the framebuffers
-		//vkDestroyImageView(device, m_DepthStencil.ImageView, nullptr);
-		//vkDestroyImage(device, m_DepthStencil.Image, nullptr);
-		//vkFreeMemory(device, m_DepthStencil.DeviceMemory, nullptr);
-		//CreateDepthStencil();
-
-		for (auto& framebuffer : m_Framebuffers)
-			vkDestroyFramebuffer(device, framebuffer, nullptr);
-
-		CreateFramebuffer();
-
-		// Command buffers need to be recreated as they may store
-		// references to the recreated frame buffer
-		vkFreeCommandBuffers(device, m_CommandPool, static_cast<uint32_t>(m_DrawCommandBuffers.size()), m_DrawCommandBuffers.data());
-		CreateDrawBuffers();
+	}
 
-		vkDeviceWaitIdle(device);
+	VkCommandBuffer VulkanSwapchain::GetCurrentDrawCommandBuffer()
+	{
+		return GetDrawCommandBuffer(Renderer::GetCurrentFrameIndex());
 	}
 
 	void VulkanSwapchain::BeginFrame()
 	{
-		VK_CHECK_RESULT(AcquireNextImage(m_Semaphores.PresentComplete, &m_CurrentBufferIndex));
+		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
+
+		// Only block until the GPU has finished the frame that last used this slot, the other frames keep running
+		m_Device->GetTimeline(VulkanQueueType::Graphics).Wait(m_FrameTimelineValues[frameIndex]);
+
+		// Offscreen images are owned per frame in flight, nothing to acquire
+		if (m_Headless)
+		{
+			m_CurrentBufferIndex = frameIndex;
+			return;
+		}
+
+		VkResult result = AcquireNextImage(m_PresentCompleteSemaphores[frameIndex], &m_CurrentBufferIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			OnResize(m_Width, m_Height);
+			result = AcquireNextImage(m_PresentCompleteSemaphores[frameIndex], &m_CurrentBufferIndex);
+		}
+
+		if (result != VK_SUBOPTIMAL_KHR)
+			VK_CHECK_RESULT(result);
 	}
 
 	void VulkanSwapchain::Present()
 	{
-		const uint64_t DEFAULT_FENCE_TIMEOUT = 100000000000;
-
-		// Use a fence to wait until the command buffer has finished execution before using it again
-		VK_CHECK_RESULT(vkWaitForFences(m_Device->GetVulkanDevice(), 1, &m_WaitFences[m_CurrentBufferIndex], VK_TRUE, UINT64_MAX));
-		VK_CHECK_RESULT(vkResetFences(m_Device->GetVulkanDevice(), 1, &m_WaitFences[m_CurrentBufferIndex]));
+		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 
 		// Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
 		VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -432,24 +450,30 @@ namespace Xero {
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		submitInfo.pWaitDstStageMask = &waitStageMask;
-		submitInfo.pWaitSemaphores = &m_Semaphores.PresentComplete;
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &m_Semaphores.RenderComplete;
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pCommandBuffers = &m_DrawCommandBuffers[m_CurrentBufferIndex];
+		submitInfo.pWaitSemaphores = &m_PresentCompleteSemaphores[frameIndex];
+		submitInfo.waitSemaphoreCount = m_Headless ? 0 : 1;
+		submitInfo.pSignalSemaphores = &m_RenderCompleteSemaphores[frameIndex];
+		submitInfo.signalSemaphoreCount = m_Headless ? 0 : 1;
+		submitInfo.pCommandBuffers = &m_DrawCommandBuffers[frameIndex];
 		submitInfo.commandBufferCount = 1;
 
-		// Submit to the graphics queue passing a wait fence
-		VK_CHECK_RESULT(vkQueueSubmit(m_Device->GetGraphicsQueue(), 1, &submitInfo, m_WaitFences[m_CurrentBufferIndex]));
+		// Also wait on any async compute work this frame consumes. The timeline value is what BeginFrame waits on
+		// the next time this slot comes round
+		const auto& computeWaits = VulkanRenderer::GetCurrentFrameContext().GetGraphicsTimelineWaits();
+		m_FrameTimelineValues[frameIndex] = m_Device->Submit(VulkanQueueType::Graphics, submitInfo, VK_NULL_HANDLE, computeWaits);
+
+		if (m_Headless)
+			return;
 
 		// Present the current buffer to the swap chain
 		// Pass the semaphore signaled by the command buffer submission from the submit info as the wait semaphore for swap chain presentation
 		// This ensures that the image is not presented to the windowing system until all commands have been submitted
-		VkResult result = QueuePresent(m_Device->GetGraphicsQueue(), m_CurrentBufferIndex, m_Semaphores.RenderComplete);
+		VkResult result = QueuePresent(m_Device->GetGraphicsQueue(), m_CurrentBufferIndex, m_RenderCompleteSemaphores[frameIndex]);
 
+		// No wait here, the CPU moves on to record the next frame while the GPU works through this one
 		if (result != VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
 		{
-			if (result == VK_ERROR_OUT_OF_DATE_KHR)
+			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 			{
 				// Swap chain is no longer compatible with the surface and needs to be recreated
 				OnResize(m_Width, m_Height);
@@ -460,14 +484,129 @@ namespace Xero {
 				VK_CHECK_RESULT(result);
 			}
 		}
+	}
+
+	bool VulkanSwapchain::Capture(const std::filesystem::path& filepath)
+	{
+		XO_CORE_ASSERT(m_Headless, "Only offscreen images can be captured");
+		XO_CORE_ASSERT(m_ColorFormat == VK_FORMAT_R8G8B8A8_UNORM);
+
+		VkDeviceSize size = (VkDeviceSize)m_Width * m_Height * 4;
+
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator("Swapchain");
+		VkBuffer readbackBuffer;
+		VmaAllocation readbackAllocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_GPU_TO_CPU, readbackBuffer);
+
+		// Goes out after the frame's submit on the same queue. The render pass leaves the image in TRANSFER_SRC and its
+		// external dependency orders the color writes and the layout transition before transfer reads
+		VkImage image = m_Images[m_CurrentBufferIndex];
+		uint32_t width = m_Width, height = m_Height;
+		VulkanRenderer::GetImmediateSubmitter().Submit([image, readbackBuffer, width, height](VkCommandBuffer commandBuffer)
+		{
+			VkBufferImageCopy region{};
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			region.imageExtent = { width, height, 1 };
+			vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+			VkBufferMemoryBarrier hostBarrier{};
+			hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			hostBarrier.buffer = readbackBuffer;
+			hostBarrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+		});
+
+		vmaInvalidateAllocation(VulkanAllocator::GetVMAAllocator(), readbackAllocation, 0, VK_WHOLE_SIZE);
+		uint8_t* pixels = allocator.MapMemory<uint8_t>(readbackAllocation);
+
+		bool result = false;
+		if (filepath.has_parent_path())
+			std::filesystem::create_directories(filepath.parent_path());
+
+		if (filepath.extension() == ".png")
+		{
+			result = stbi_write_png(filepath.string().c_str(), (int)width, (int)height, 4, pixels, (int)width * 4) != 0;
+		}
+		else
+		{
+			std::ofstream stream(filepath, std::ios::binary);
+			if (stream)
+			{
+				stream.write((const char*)pixels, (std::streamsize)size);
+				result = stream.good();
+			}
+		}
 
-		VK_CHECK_RESULT(vkWaitForFences(m_Device->GetVulkanDevice(), 1, &m_WaitFences[m_CurrentBufferIndex], VK_TRUE, DEFAULT_FENCE_TIMEOUT));
+		allocator.UnmapMemory(readbackAllocation);
+		// The submit above has completed, nothing on the GPU references the buffer any more
+		allocator.DestroyBufferImmediate(readbackBuffer, readbackAllocation);
+
+		if (!result)
+		{
+			XO_CORE_ERROR("Failed to write frame capture to {0}", filepath.string());
+			return false;
+		}
+
+		XO_CORE_INFO("Captured frame ({0}x{1}) to {2}", width, height, filepath.string());
+		return true;
 	}
 
 	void VulkanSwapchain::Cleanup()
 	{
 		VkDevice device = m_Device->GetVulkanDevice();
 
+		// Frames in flight still use all of it
+		vkDeviceWaitIdle(device);
+
+		// Swapchains retired by a resize sit in the deletion queue, they have to go before the surface
+		VulkanRenderer::FlushResourceFrees();
+
+		for (VkFramebuffer framebuffer : m_Framebuffers)
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		m_Framebuffers.clear();
+
+		if (m_RenderPass)
+		{
+			vkDestroyRenderPass(device, m_RenderPass, nullptr);
+			m_RenderPass = VK_NULL_HANDLE;
+		}
+
+		if (m_DepthStencil.Image)
+		{
+			vkDestroyImageView(device, m_DepthStencil.ImageView, nullptr);
+			VulkanAllocator allocator("Swapchain");
+			allocator.DestroyImageImmediate(m_DepthStencil.Image, m_DepthStencil.MemoryAlloc);
+			m_DepthStencil = {};
+		}
+
+		// Frees the draw command buffers with it
+		if (m_CommandPool)
+		{
+			vkDestroyCommandPool(device, m_CommandPool, nullptr);
+			m_CommandPool = VK_NULL_HANDLE;
+			m_DrawCommandBuffers.clear();
+		}
+
+		for (VkSemaphore semaphore : m_PresentCompleteSemaphores)
+			vkDestroySemaphore(device, semaphore, nullptr);
+		for (VkSemaphore semaphore : m_RenderCompleteSemaphores)
+			vkDestroySemaphore(device, semaphore, nullptr);
+		m_PresentCompleteSemaphores.clear();
+		m_RenderCompleteSemaphores.clear();
+		m_FrameTimelineValues.clear();
+
+		if (m_Headless)
+			DestroyOffscreenImages(true);
+
 		if (m_Swapchain)
 		{
 			for (uint32_t i = 0; i < m_ImageCount; i++)
@@ -505,11 +644,94 @@ namespace Xero {
 			presentInfo.waitSemaphoreCount = 1;
 		}
 
+		// Presenting uses the queue too, so it takes the device's submit lock
+		std::scoped_lock<std::mutex> lock(m_Device->GetQueueMutex());
 		return fpQueuePresentKHR(queue, &presentInfo);
 	}
 
+	void VulkanSwapchain::CreateOffscreenImages()
+	{
+		DestroyOffscreenImages(false);
+
+		VkDevice device = m_Device->GetVulkanDevice();
+		VulkanAllocator allocator("Swapchain");
+
+		// One image per frame in flight, so an image is only rendered to again once its frame has completed
+		m_ImageCount = Renderer::GetConfig().FramesInFlight;
+		m_Images.resize(m_ImageCount);
+		m_Buffers.resize(m_ImageCount);
+		m_OffscreenAllocations.resize(m_ImageCount);
+		for (uint32_t i = 0; i < m_ImageCount; i++)
+		{
+			VkImageCreateInfo imageCreateInfo{};
+			imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = m_ColorFormat;
+			imageCreateInfo.extent = { m_Width, m_Height, 1 };
+			imageCreateInfo.mipLevels = 1;
+			imageCreateInfo.arrayLayers = 1;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+			m_OffscreenAllocations[i] = allocator.AllocateImage(imageCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, m_Images[i]);
+
+			VkImageViewCreateInfo colorAttachmentView{};
+			colorAttachmentView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			colorAttachmentView.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			colorAttachmentView.image = m_Images[i];
+			colorAttachmentView.format = m_ColorFormat;
+			colorAttachmentView.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			m_Buffers[i].Image = m_Images[i];
+			VK_CHECK_RESULT(vkCreateImageView(device, &colorAttachmentView, nullptr, &m_Buffers[i].View));
+		}
+	}
+
+	void VulkanSwapchain::DestroyOffscreenImages(bool immediate)
+	{
+		if (m_OffscreenAllocations.empty())
+			return;
+
+		VkDevice device = m_Device->GetVulkanDevice();
+		VulkanAllocator allocator("Swapchain");
+
+		std::vector<VkImageView> views;
+		for (uint32_t i = 0; i < m_ImageCount; i++)
+		{
+			views.push_back(m_Buffers[i].View);
+			if (immediate)
+				allocator.DestroyImageImmediate(m_Images[i], m_OffscreenAllocations[i]);
+			else
+				allocator.DestroyImage(m_Images[i], m_OffscreenAllocations[i]);
+		}
+
+		auto destroyViews = [device, views]()
+		{
+			for (VkImageView view : views)
+				vkDestroyImageView(device, view, nullptr);
+		};
+
+		if (immediate)
+			destroyViews();
+		else
+			VulkanRenderer::SubmitResourceFree(std::move(destroyViews));
+
+		m_OffscreenAllocations.clear();
+	}
+
 	void VulkanSwapchain::CreateFramebuffer()
 	{
+		if (!m_Framebuffers.empty())
+		{
+			VkDevice device = m_Device->GetVulkanDevice();
+			VulkanRenderer::SubmitResourceFree([device, framebuffers = m_Framebuffers]()
+			{
+				for (VkFramebuffer framebuffer : framebuffers)
+					vkDestroyFramebuffer(device, framebuffer, nullptr);
+			});
+		}
+
 		// Setup framebuffer
 		VkImageView ivAttachments[2];
 
@@ -540,6 +762,13 @@ namespace Xero {
 		VkDevice device = m_Device->GetVulkanDevice();
 		VkFormat depthFormat = m_Device->GetPhysicalDevice()->GetDepthFormat();
 
+		VulkanAllocator allocator("Swapchain");
+		if (m_DepthStencil.Image)
+		{
+			VulkanRenderer::SubmitResourceFree([device, view = m_DepthStencil.ImageView]() { vkDestroyImageView(device, view, nullptr); });
+			allocator.DestroyImage(m_DepthStencil.Image, m_DepthStencil.MemoryAlloc);
+		}
+
 		VkImageCreateInfo imageCreateInfo{};
 		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -550,7 +779,6 @@ namespace Xero {
 		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-		VulkanAllocator allocator("Swapchain");
 		m_DepthStencil.MemoryAlloc = allocator.AllocateImage(imageCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, m_DepthStencil.Image);
 
 		VkImageViewCreateInfo imageViewCreateInfo{};
@@ -573,15 +801,22 @@ namespace Xero {
 
 	void VulkanSwapchain::CreateDrawBuffers()
 	{
-		// Create one command buffer for each swap chain image and reuse for rendering
-		m_DrawCommandBuffers.resize(m_ImageCount);
+		// Kept across swapchain recreation, they hold no references once re-recorded
+		if (!m_DrawCommandBuffers.empty())
+			return;
+
+		// One command buffer per frame in flight, a buffer is only re-recorded once its frame has completed
+		m_DrawCommandBuffers.resize(Renderer::GetConfig().FramesInFlight);
 
 		// TODO: Move this somewhere maybe?
-		VkCommandPoolCreateInfo cmdPoolInfo = {};
-		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		cmdPoolInfo.queueFamilyIndex = m_QueueNodeIndex;
-		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		VK_CHECK_RESULT(vkCreateCommandPool(m_Device->GetVulkanDevice(), &cmdPoolInfo, nullptr, &m_CommandPool));
+		if (!m_CommandPool)
+		{
+			VkCommandPoolCreateInfo cmdPoolInfo = {};
+			cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			cmdPoolInfo.queueFamilyIndex = m_QueueNodeIndex;
+			cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			VK_CHECK_RESULT(vkCreateCommandPool(m_Device->GetVulkanDevice(), &cmdPoolInfo, nullptr, &m_CommandPool));
+		}
 
 		VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
 		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -591,6 +826,30 @@ namespace Xero {
 		VK_CHECK_RESULT(vkAllocateCommandBuffers(m_Device->GetVulkanDevice(), &commandBufferAllocateInfo, m_DrawCommandBuffers.data()));
 	}
 
+	void VulkanSwapchain::CreateSyncObjects()
+	{
+		// Survive swapchain recreation, frames still in flight may be waiting on them
+		if (!m_FrameTimelineValues.empty())
+			return;
+
+		uint32_t framesInFlight = Renderer::GetConfig().FramesInFlight;
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo{};
+		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		m_PresentCompleteSemaphores.resize(framesInFlight);
+		m_RenderCompleteSemaphores.resize(framesInFlight);
+		// Zero is always reached, so the first wait on each slot returns immediately
+		m_FrameTimelineValues.resize(framesInFlight, 0);
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			// Signaled by the acquire, ensures the image is available before we render to it
+			VK_CHECK_RESULT(vkCreateSemaphore(m_Device->GetVulkanDevice(), &semaphoreCreateInfo, nullptr, &m_PresentCompleteSemaphores[i]));
+			// Signaled by the submit, ensures the image is not presented until rendering has finished
+			VK_CHECK_RESULT(vkCreateSemaphore(m_Device->GetVulkanDevice(), &semaphoreCreateInfo, nullptr, &m_RenderCompleteSemaphores[i]));
+		}
+	}
+
 	void VulkanSwapchain::FindImageFormatAndColorSpace()
 	{
 		VkPhysicalDevice physicalDevice = m_Device->GetPhysicalDevice()->GetVulkanPhysicalDevice();
@@ -6,6 +6,8 @@
 #include "VulkanDevice.h"
 #include "VulkanAllocator.h"
 
+#include <filesystem>
+
 struct GLFWwinow;
 
 namespace Xero {
@@ -17,6 +19,8 @@ namespace Xero {
 		
 		void Init(VkInstance instance, const Ref<VulkanDevice>& device);
 		void InitSurface(GLFWwindow* windowHandle);
+		// No surface or swapchain, frames cycle through FramesInFlight offscreen images instead
+		void InitHeadless(const Ref<VulkanDevice>& device);
 
 		void Create(uint32_t* width, uint32_t* height, bool vsync = false);
 
@@ -25,6 +29,12 @@ namespace Xero {
 		void BeginFrame();
 		void Present();
 
+		// Headless only. Copies the last presented image to a .png, any other extension gets the raw RGBA8 rows.
+		// Blocks until the copy has completed, meant for tests and benchmarks rather than every frame
+		bool Capture(const std::filesystem::path& filepath);
+
+		bool IsHeadless() const { return m_Headless; }
+
 		uint32_t GetImageCount() const { return m_ImageCount; }
 		
 		uint32_t GetWidth() const { return m_Width; }
@@ -33,10 +43,11 @@ namespace Xero {
 		VkRenderPass GetRenderPass() { return m_RenderPass; }
 
 		VkFramebuffer GetCurrentFramebuffer() { return GetFramebuffer(m_CurrentBufferIndex); }
-		VkCommandBuffer GetCurrentDrawCommandBuffer() { return GetDrawCommandBuffer(m_CurrentBufferIndex); }
+		VkCommandBuffer GetCurrentDrawCommandBuffer();
 
 		VkFormat GetColorFormat() { return m_ColorFormat; }
 
+		// Index of the acquired swapchain image, only use it for per-image resources such as framebuffers
 		uint32_t GetCurrentBufferIndex() const { return m_CurrentBufferIndex; }
 		VkFramebuffer GetFramebuffer(uint32_t index)
 		{
@@ -46,19 +57,24 @@ namespace Xero {
 
 		VkCommandBuffer GetDrawCommandBuffer(uint32_t index)
 		{
-			XO_ASSERT(index < m_ImageCount);
+			XO_ASSERT(index < m_DrawCommandBuffers.size());
 			return m_DrawCommandBuffers[index];
 		}
 
+		// Releases everything the swapchain owns. Has to run before the context goes, which reports live allocations
 		void Cleanup();
 
 	private:
 		VkResult AcquireNextImage(VkSemaphore presentCompleteSemaphore, uint32_t* imageIndex);
 		VkResult QueuePresent(VkQueue queue, uint32_t imageIndex, VkSemaphore waitSemaphore = VK_NULL_HANDLE);
 
+		void CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync);
+		void CreateOffscreenImages();
+		void DestroyOffscreenImages(bool immediate);
 		void CreateFramebuffer();
 		void CreateDepthStencil();
 		void CreateDrawBuffers();
+		void CreateSyncObjects();
 		void FindImageFormatAndColorSpace();
 
 	private:
@@ -78,34 +94,33 @@ namespace Xero {
 			VkImageView View;
 		};
 		std::vector<SwapchainBuffer> m_Buffers;
+		std::vector<VmaAllocation> m_OffscreenAllocations; // Headless, backs m_Images
+
+		bool m_Headless = false;
 
 		struct
 		{
-			VkImage Image;
-			VmaAllocation MemoryAlloc;
-			VkImageView ImageView;
+			VkImage Image = VK_NULL_HANDLE;
+			VmaAllocation MemoryAlloc = nullptr;
+			VkImageView ImageView = VK_NULL_HANDLE;
 		} m_DepthStencil;
 
 		std::vector<VkFramebuffer> m_Framebuffers;
-		VkCommandPool m_CommandPool;
-		std::vector<VkCommandBuffer> m_DrawCommandBuffers;
-
-		struct
-		{
-			VkSemaphore PresentComplete;
-			VkSemaphore RenderComplete;
-		} m_Semaphores;
-		VkSubmitInfo m_SubmitInfo;
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> m_DrawCommandBuffers; // One per frame in flight
 
-		std::vector<VkFence> m_WaitFences;
+		// Synchronization objects, indexed by frame in flight rather than by image
+		std::vector<VkSemaphore> m_PresentCompleteSemaphores;
+		std::vector<VkSemaphore> m_RenderCompleteSemaphores;
+		std::vector<uint64_t> m_FrameTimelineValues; // Graphics timeline value of each slot's last submit
 
-		VkRenderPass m_RenderPass;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
 		uint32_t m_CurrentBufferIndex = 0;
 
 		uint32_t m_QueueNodeIndex = UINT32_MAX;
 		uint32_t m_Width = 0, m_Height = 0;
 
-		VkSurfaceKHR m_Surface;
+		VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
 
 		friend class VulkanContext;
 	};
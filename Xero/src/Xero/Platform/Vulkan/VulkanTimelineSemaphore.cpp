@@ -0,0 +1,61 @@
+#include "xopch.h"
+#include "VulkanTimelineSemaphore.h"
+
+namespace Xero {
+
+	VulkanTimelineSemaphore::VulkanTimelineSemaphore(VkDevice device, uint64_t initialValue)
+		: m_Device(device), m_LastReservedValue(initialValue)
+	{
+		VkSemaphoreTypeCreateInfo typeCreateInfo{};
+		typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeCreateInfo.initialValue = initialValue;
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo{};
+		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreCreateInfo.pNext = &typeCreateInfo;
+		VK_CHECK_RESULT(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr, &m_Semaphore));
+	}
+
+	VulkanTimelineSemaphore::~VulkanTimelineSemaphore()
+	{
+		vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+	}
+
+	uint64_t VulkanTimelineSemaphore::GetCompletedValue() const
+	{
+		uint64_t value = 0;
+		VK_CHECK_RESULT(vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &value));
+		return value;
+	}
+
+	bool VulkanTimelineSemaphore::Wait(uint64_t value, uint64_t timeout) const
+	{
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_Semaphore;
+		waitInfo.pValues = &value;
+
+		VkResult result = vkWaitSemaphores(m_Device, &waitInfo, timeout);
+		if (result == VK_TIMEOUT)
+			return false;
+
+		VK_CHECK_RESULT(result);
+		return true;
+	}
+
+	void VulkanTimelineSemaphore::Signal(uint64_t value)
+	{
+		VkSemaphoreSignalInfo signalInfo{};
+		signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+		signalInfo.semaphore = m_Semaphore;
+		signalInfo.value = value;
+		VK_CHECK_RESULT(vkSignalSemaphore(m_Device, &signalInfo));
+
+		// Later GPU signals have to go past the host value
+		uint64_t reserved = m_LastReservedValue;
+		while (reserved < value && !m_LastReservedValue.compare_exchange_weak(reserved, value));
+	}
+
+}
\ No newline at end of file
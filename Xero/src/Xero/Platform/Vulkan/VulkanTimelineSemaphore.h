@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vulkan.h"
+
+#include <atomic>
+
+namespace Xero {
+
+	// Monotonic GPU counter (Vulkan 1.2 timeline semaphore). Submits signal increasing values, the CPU
+	// and other queues wait on or poll any value, which replaces per-submit fences and binary semaphores
+	class VulkanTimelineSemaphore
+	{
+	public:
+		VulkanTimelineSemaphore(VkDevice device, uint64_t initialValue = 0);
+		~VulkanTimelineSemaphore();
+
+		VulkanTimelineSemaphore(const VulkanTimelineSemaphore&) = delete;
+		VulkanTimelineSemaphore& operator=(const VulkanTimelineSemaphore&) = delete;
+
+		// Reserves the value the next signal operation will write
+		uint64_t AcquireNextValue() { return ++m_LastReservedValue; }
+		uint64_t GetLastReservedValue() const { return m_LastReservedValue; }
+
+		uint64_t GetCompletedValue() const;
+		bool IsComplete(uint64_t value) const { return value <= GetCompletedValue(); }
+		// Returns false on timeout
+		bool Wait(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+
+		// Host-side signal, the value has to be greater than the current one
+		void Signal(uint64_t value);
+
+		VkSemaphore GetVulkanSemaphore() const { return m_Semaphore; }
+
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+		std::atomic<uint64_t> m_LastReservedValue = 0;
+	};
+
+}
\ No newline at end of file
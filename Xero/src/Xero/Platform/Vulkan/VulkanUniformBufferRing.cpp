@@ -0,0 +1,74 @@
+#include "xopch.h"
+#include "VulkanUniformBufferRing.h"
+
+#include "VulkanContext.h"
+
+#include "Xero/Utils/StringUtils.h"
+
+namespace Xero {
+
+	VulkanUniformBufferRing::VulkanUniformBufferRing(uint32_t framesInFlight, VkDeviceSize regionSize)
+	{
+		const auto& limits = VulkanContext::GetCurrentDevice()->GetPhysicalDevice()->GetProperties().limits;
+		m_Alignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+		m_RegionSize = (regionSize + m_Alignment - 1) & ~(m_Alignment - 1);
+
+		// Dynamic offsets are 32 bit
+		XO_CORE_ASSERT(m_RegionSize * framesInFlight <= UINT32_MAX);
+
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = m_RegionSize * framesInFlight;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator("UniformRing");
+		m_Allocation = allocator.AllocateBuffer(bufferCreateInfo, "Transient", m_Buffer);
+		m_Data = allocator.MapMemory<uint8_t>(m_Allocation);
+	}
+
+	VulkanUniformBufferRing::~VulkanUniformBufferRing()
+	{
+		// Owned by the renderer, which waits for the device before tearing down
+		VulkanAllocator allocator("UniformRing");
+		allocator.UnmapMemory(m_Allocation);
+		allocator.DestroyBufferImmediate(m_Buffer, m_Allocation);
+	}
+
+	void VulkanUniformBufferRing::Begin(uint32_t frameIndex)
+	{
+		VkDeviceSize used = m_Head.exchange(0);
+		if (used > m_RegionSize)
+			XO_CORE_ERROR("VulkanUniformBufferRing: last frame needed {0} of uniform data, the region holds {1}", Utils::BytesToString(used), Utils::BytesToString(m_RegionSize));
+
+		m_RegionBegin = frameIndex * m_RegionSize;
+	}
+
+	VulkanUniformBufferRing::Allocation VulkanUniformBufferRing::Allocate(uint32_t size)
+	{
+		VkDeviceSize alignedSize = (size + m_Alignment - 1) & ~(m_Alignment - 1);
+		VkDeviceSize offset = m_Head.fetch_add(alignedSize);
+
+		if (offset + alignedSize > m_RegionSize)
+		{
+			// Only the allocation that crosses the end reports, the rest of the frame would repeat it
+			if (offset <= m_RegionSize)
+				XO_CORE_ERROR("VulkanUniformBufferRing: out of space allocating {0}, raise RendererConfig::UniformBufferRegionSize ({1})", Utils::BytesToString(alignedSize), Utils::BytesToString(m_RegionSize));
+			XO_CORE_ASSERT(false, "Uniform buffer ring region is full");
+
+			// Without asserts the draw reads another draw's data, aliasing the start keeps the offset valid for the descriptor range
+			offset = 0;
+		}
+
+		VkDeviceSize bufferOffset = m_RegionBegin + offset;
+		return { (uint32_t)bufferOffset, m_Data + bufferOffset };
+	}
+
+	uint32_t VulkanUniformBufferRing::Write(const void* data, uint32_t size)
+	{
+		Allocation allocation = Allocate(size);
+		memcpy(allocation.Data, data, size);
+		return allocation.Offset;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanAllocator.h"
+
+#include <atomic>
+
+namespace Xero {
+
+	// Backs every reflected uniform buffer binding. One persistently mapped buffer is split into a region per frame in
+	// flight; updates are bump-allocated from the current frame's region and bound through dynamic offsets. Descriptors
+	// point at the buffer with offset 0, so they are written once when a set is allocated and never again
+	class VulkanUniformBufferRing
+	{
+	public:
+		struct Allocation
+		{
+			uint32_t Offset = 0; // Dynamic offset to bind with
+			void* Data = nullptr;
+		};
+
+	public:
+		VulkanUniformBufferRing(uint32_t framesInFlight, VkDeviceSize regionSize = 4 * 1024 * 1024);
+		~VulkanUniformBufferRing();
+
+		// The GPU has finished with the frame slot, its region starts over
+		void Begin(uint32_t frameIndex);
+
+		// Safe from recording threads. size should cover the reflected size of the block, the descriptor range reads that much
+		Allocation Allocate(uint32_t size);
+		uint32_t Write(const void* data, uint32_t size);
+
+		VkBuffer GetBuffer() const { return m_Buffer; }
+		VkDeviceSize GetRegionSize() const { return m_RegionSize; }
+		VkDeviceSize GetRegionUsed() const { return std::min<VkDeviceSize>(m_Head, m_RegionSize); }
+
+	private:
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VmaAllocation m_Allocation = nullptr;
+		uint8_t* m_Data = nullptr;
+
+		VkDeviceSize m_RegionSize = 0;
+		VkDeviceSize m_RegionBegin = 0;
+		VkDeviceSize m_Alignment = 256;
+		std::atomic<VkDeviceSize> m_Head = 0; // Relative to the region begin
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "xopch.h"
+#include "VulkanUploadScheduler.h"
+
+#include "VulkanContext.h"
+
+namespace Xero {
+
+	VulkanUploadScheduler::VulkanUploadScheduler(VkDeviceSize stagingSize)
+		: m_StagingSize(stagingSize)
+	{
+		auto device = VulkanContext::GetCurrentDevice();
+		const auto& queueFamilyIndices = device->GetPhysicalDevice()->GetQueueFamilyIndices();
+		m_GraphicsFamily = queueFamilyIndices.Graphics;
+		m_TransferFamily = queueFamilyIndices.Transfer;
+
+		VkCommandPoolCreateInfo cmdPoolInfo = {};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		cmdPoolInfo.queueFamilyIndex = m_TransferFamily;
+		VK_CHECK_RESULT(vkCreateCommandPool(device->GetVulkanDevice(), &cmdPoolInfo, nullptr, &m_TransferCommandPool));
+
+		if (HasOwnershipTransfer())
+		{
+			cmdPoolInfo.queueFamilyIndex = m_GraphicsFamily;
+			VK_CHECK_RESULT(vkCreateCommandPool(device->GetVulkanDevice(), &cmdPoolInfo, nullptr, &m_GraphicsCommandPool));
+		}
+
+		// Image copies want their source offset aligned to the texel block, 16 covers every uncompressed format
+		m_StagingAlignment = std::max<VkDeviceSize>(16, device->GetPhysicalDevice()->GetProperties().limits.optimalBufferCopyOffsetAlignment);
+
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = m_StagingSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator("UploadStaging");
+		m_Staging.Allocation = allocator.AllocateBuffer(bufferCreateInfo, VMA_MEMORY_USAGE_CPU_ONLY, m_Staging.Buffer);
+		m_StagingData = allocator.MapMemory<uint8_t>(m_Staging.Allocation);
+	}
+
+	VulkanUploadScheduler::~VulkanUploadScheduler()
+	{
+		// Owned by the renderer, which waits for the device before tearing down
+		if (m_PendingBatch)
+			DestroyBatch(*m_PendingBatch);
+		for (Batch& batch : m_InFlightBatches)
+		{
+			RetireBatch(batch);
+			DestroyBatch(batch);
+		}
+		for (Batch& batch : m_FreeBatches)
+			DestroyBatch(batch);
+
+		VulkanAllocator allocator("UploadStaging");
+		allocator.UnmapMemory(m_Staging.Allocation);
+		allocator.DestroyBufferImmediate(m_Staging.Buffer, m_Staging.Allocation);
+
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+		vkDestroyCommandPool(device, m_TransferCommandPool, nullptr);
+		if (m_GraphicsCommandPool)
+			vkDestroyCommandPool(device, m_GraphicsCommandPool, nullptr);
+	}
+
+	VulkanUploadToken VulkanUploadScheduler::UploadBuffer(VkBuffer buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		XO_CORE_ASSERT(buffer && data && size);
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		auto [stagingBuffer, stagingOffset] = Stage(data, size);
+		Batch& batch = GetPendingBatch();
+
+		VkBufferCopy region{};
+		region.srcOffset = stagingOffset;
+		region.dstOffset = dstOffset;
+		region.size = size;
+		vkCmdCopyBuffer(batch.TransferCommandBuffer, stagingBuffer, buffer, 1, &region);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer;
+		barrier.offset = dstOffset;
+		barrier.size = size;
+
+		if (HasOwnershipTransfer())
+		{
+			// Release half, the matching acquire is recorded on the graphics queue at flush
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = m_TransferFamily;
+			barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+
+			VkBufferMemoryBarrier acquire = barrier;
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			batch.AcquireBufferBarriers.push_back(acquire);
+		}
+
+		VkPipelineStageFlags dstStage = HasOwnershipTransfer() ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		vkCmdPipelineBarrier(batch.TransferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		batch.UploadCount++;
+		return { batch.ID };
+	}
+
+	VulkanUploadToken VulkanUploadScheduler::UploadImage(VkImage image, VkExtent3D extent, VkImageAspectFlags aspectMask, const void* data, VkDeviceSize size, VkImageLayout finalLayout)
+	{
+		XO_CORE_ASSERT(image && data && size);
+
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		auto [stagingBuffer, stagingOffset] = Stage(data, size);
+		Batch& batch = GetPendingBatch();
+
+		VkImageSubresourceRange range{};
+		range.aspectMask = aspectMask;
+		range.baseMipLevel = 0;
+		range.levelCount = 1;
+		range.baseArrayLayer = 0;
+		range.layerCount = 1;
+
+		VkImageMemoryBarrier toTransfer{};
+		toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toTransfer.srcAccessMask = 0;
+		toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image = image;
+		toTransfer.subresourceRange = range;
+		vkCmdPipelineBarrier(batch.TransferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = stagingOffset;
+		region.imageSubresource.aspectMask = aspectMask;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = extent;
+		vkCmdCopyBufferToImage(batch.TransferCommandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		// The layout transition happens once, as part of the release/acquire pair when the families differ
+		VkImageMemoryBarrier toFinal = toTransfer;
+		toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toFinal.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		toFinal.newLayout = finalLayout;
+
+		if (HasOwnershipTransfer())
+		{
+			toFinal.dstAccessMask = 0;
+			toFinal.srcQueueFamilyIndex = m_TransferFamily;
+			toFinal.dstQueueFamilyIndex = m_GraphicsFamily;
+
+			VkImageMemoryBarrier acquire = toFinal;
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			batch.AcquireImageBarriers.push_back(acquire);
+		}
+
+		VkPipelineStageFlags dstStage = HasOwnershipTransfer() ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		vkCmdPipelineBarrier(batch.TransferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &toFinal);
+
+		batch.UploadCount++;
+		return { batch.ID };
+	}
+
+	void VulkanUploadScheduler::Flush()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		if (!m_PendingBatch)
+			return;
+
+		Batch batch = std::move(*m_PendingBatch);
+		m_PendingBatch.reset();
+
+		auto device = VulkanContext::GetCurrentDevice();
+		VK_CHECK_RESULT(vkEndCommandBuffer(batch.TransferCommandBuffer));
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.TransferCommandBuffer;
+
+		uint64_t transferValue = device->Submit(VulkanQueueType::Transfer, submitInfo);
+		batch.CompletionQueue = VulkanQueueType::Transfer;
+		batch.CompletionValue = transferValue;
+
+		if (HasOwnershipTransfer())
+		{
+
+			// Acquire on graphics, the batch only counts as complete once the resources belong to it
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(batch.AcquireCommandBuffer, &beginInfo));
+			vkCmdPipelineBarrier(batch.AcquireCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+				0, nullptr,
+				(uint32_t)batch.AcquireBufferBarriers.size(), batch.AcquireBufferBarriers.data(),
+				(uint32_t)batch.AcquireImageBarriers.size(), batch.AcquireImageBarriers.data());
+			VK_CHECK_RESULT(vkEndCommandBuffer(batch.AcquireCommandBuffer));
+
+			VkSubmitInfo acquireInfo{};
+			acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			acquireInfo.commandBufferCount = 1;
+			acquireInfo.pCommandBuffers = &batch.AcquireCommandBuffer;
+
+			batch.CompletionQueue = VulkanQueueType::Graphics;
+			batch.CompletionValue = device->Submit(VulkanQueueType::Graphics, acquireInfo, VK_NULL_HANDLE, { { VulkanQueueType::Transfer, transferValue } });
+		}
+
+		XO_CORE_TRACE("VulkanUploadScheduler: submitted batch {0} with {1} uploads", batch.ID, batch.UploadCount);
+		m_InFlightBatches.push_back(std::move(batch));
+	}
+
+	void VulkanUploadScheduler::Wait(VulkanUploadToken token)
+	{
+		if (IsComplete(token))
+			return;
+
+		Flush();
+
+		// Batches complete on one queue in submission order, waiting for the newest requested one covers the rest
+		std::optional<std::pair<VulkanQueueType, uint64_t>> completion;
+		{
+			std::scoped_lock<std::mutex> lock(m_Mutex);
+			for (const Batch& batch : m_InFlightBatches)
+			{
+				if (batch.ID <= token.BatchID)
+					completion = { batch.CompletionQueue, batch.CompletionValue };
+			}
+		}
+
+		if (completion)
+			VulkanContext::GetCurrentDevice()->GetTimeline(completion->first).Wait(completion->second);
+
+		Update();
+	}
+
+	void VulkanUploadScheduler::Update()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+
+		auto device = VulkanContext::GetCurrentDevice();
+		while (!m_InFlightBatches.empty())
+		{
+			Batch& batch = m_InFlightBatches.front();
+			if (!device->GetTimeline(batch.CompletionQueue).IsComplete(batch.CompletionValue))
+				break;
+
+			m_CompletedBatchID = batch.ID;
+			RetireBatch(batch);
+
+			m_FreeBatches.push_back(std::move(batch));
+			m_InFlightBatches.pop_front();
+		}
+	}
+
+	std::pair<VkBuffer, VkDeviceSize> VulkanUploadScheduler::Stage(const void* data, VkDeviceSize size)
+	{
+		Batch& batch = GetPendingBatch();
+
+		VkDeviceSize offset = (m_StagingHead + m_StagingAlignment - 1) & ~(m_StagingAlignment - 1);
+		VkDeviceSize consumed = offset - m_StagingHead + size;
+		if (offset + size > m_StagingSize)
+		{
+			// Wrap around, the tail end of the ring is skipped and counted against this batch
+			offset = 0;
+			consumed = m_StagingSize - m_StagingHead + size;
+		}
+
+		if (m_StagingUsed + consumed <= m_StagingSize)
+		{
+			memcpy(m_StagingData + offset, data, size);
+
+			m_StagingHead = offset + size;
+			m_StagingUsed += consumed;
+			batch.StagingBytes += consumed;
+			return { m_Staging.Buffer, offset };
+		}
+
+		// The ring is full or the upload is larger than it, fall back to a buffer of its own rather than waiting
+		XO_CORE_WARN("VulkanUploadScheduler: staging ring exhausted, using a dedicated {0} byte staging buffer", size);
+
+		VkBufferCreateInfo bufferCreateInfo{};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = size;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator("UploadStaging");
+		StagingBuffer& staging = batch.DedicatedStaging.emplace_back();
+		staging.Allocation = allocator.AllocateBuffer(bufferCreateInfo, "Staging", staging.Buffer);
+
+		uint8_t* mapped = allocator.MapMemory<uint8_t>(staging.Allocation);
+		memcpy(mapped, data, size);
+		allocator.UnmapMemory(staging.Allocation);
+
+		return { staging.Buffer, 0 };
+	}
+
+	VulkanUploadScheduler::Batch& VulkanUploadScheduler::GetPendingBatch()
+	{
+		if (m_PendingBatch)
+			return *m_PendingBatch;
+
+		if (m_FreeBatches.empty())
+		{
+			m_PendingBatch = CreateBatch();
+		}
+		else
+		{
+			m_PendingBatch = std::move(m_FreeBatches.back());
+			m_FreeBatches.pop_back();
+		}
+
+		Batch& batch = *m_PendingBatch;
+		batch.ID = m_NextBatchID++;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK_RESULT(vkBeginCommandBuffer(batch.TransferCommandBuffer, &beginInfo));
+
+		return batch;
+	}
+
+	VulkanUploadScheduler::Batch VulkanUploadScheduler::CreateBatch()
+	{
+		VkDevice device = VulkanContext::GetCurrentDevice()->GetVulkanDevice();
+
+		Batch batch;
+
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+		allocateInfo.commandPool = m_TransferCommandPool;
+		VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocateInfo, &batch.TransferCommandBuffer));
+
+		if (HasOwnershipTransfer())
+		{
+			allocateInfo.commandPool = m_GraphicsCommandPool;
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocateInfo, &batch.AcquireCommandBuffer));
+		}
+
+		return batch;
+	}
+
+	void VulkanUploadScheduler::RetireBatch(Batch& batch)
+	{
+		m_StagingUsed -= batch.StagingBytes;
+		batch.StagingBytes = 0;
+
+		// Nothing left in the ring, start over at the front so the next batch does not wrap needlessly
+		if (m_StagingUsed == 0)
+			m_StagingHead = 0;
+
+		VulkanAllocator allocator("UploadStaging");
+		for (StagingBuffer& staging : batch.DedicatedStaging)
+			allocator.DestroyBufferImmediate(staging.Buffer, staging.Allocation);
+		batch.DedicatedStaging.clear();
+
+		batch.AcquireBufferBarriers.clear();
+		batch.AcquireImageBarriers.clear();
+		batch.UploadCount = 0;
+	}
+
+	void VulkanUploadScheduler::DestroyBatch(Batch& batch)
+	{
+		VulkanAllocator allocator("UploadStaging");
+		for (StagingBuffer& staging : batch.DedicatedStaging)
+			allocator.DestroyBufferImmediate(staging.Buffer, staging.Allocation);
+
+		// Command buffers go with their pools
+	}
+
+}
\ No newline at end of file
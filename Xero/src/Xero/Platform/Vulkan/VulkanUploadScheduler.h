@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "VulkanAllocator.h"
+
+#include <mutex>
+#include <deque>
+#include <optional>
+#include <atomic>
+
+namespace Xero {
+
+	// Identifies the batch an upload was recorded into, an empty token is always complete
+	struct VulkanUploadToken
+	{
+		uint64_t BatchID = 0;
+	};
+
+	// Streams buffer and image data through a persistently mapped staging ring on the transfer queue.
+	// Uploads from any thread are batched into a single submit per Flush, ownership is released to the
+	// graphics family and acquired there, callers poll tokens instead of waiting on the GPU
+	class VulkanUploadScheduler
+	{
+	public:
+		VulkanUploadScheduler(VkDeviceSize stagingSize = 32 * 1024 * 1024);
+		~VulkanUploadScheduler();
+
+		// The destination is readable from any graphics stage once the token completes
+		VulkanUploadToken UploadBuffer(VkBuffer buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+		// Writes mip 0 of layer 0, the image is expected to be in the undefined layout
+		VulkanUploadToken UploadImage(VkImage image, VkExtent3D extent, VkImageAspectFlags aspectMask, const void* data, VkDeviceSize size,
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		void Flush();
+		void Wait(VulkanUploadToken token);
+
+		// Retires batches whose timeline value has been reached and releases their staging space
+		void Update();
+
+		bool IsComplete(VulkanUploadToken token) const { return token.BatchID <= m_CompletedBatchID; }
+
+		VkDeviceSize GetStagingSize() const { return m_StagingSize; }
+		VkDeviceSize GetStagingUsed() const { return m_StagingUsed; }
+
+	private:
+		struct StagingBuffer
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VmaAllocation Allocation = nullptr;
+		};
+
+		struct Batch
+		{
+			uint64_t ID = 0;
+			VkCommandBuffer TransferCommandBuffer = VK_NULL_HANDLE;
+			VkCommandBuffer AcquireCommandBuffer = VK_NULL_HANDLE;
+
+			// Timeline value of the last submit of the batch, graphics when ownership is transferred
+			VulkanQueueType CompletionQueue = VulkanQueueType::Transfer;
+			uint64_t CompletionValue = 0;
+
+			VkDeviceSize StagingBytes = 0;
+			std::vector<StagingBuffer> DedicatedStaging; // Uploads that did not fit in the ring
+
+			std::vector<VkBufferMemoryBarrier> AcquireBufferBarriers;
+			std::vector<VkImageMemoryBarrier> AcquireImageBarriers;
+			uint32_t UploadCount = 0;
+		};
+
+		// Returns the staging buffer and offset to copy from, data is already written
+		std::pair<VkBuffer, VkDeviceSize> Stage(const void* data, VkDeviceSize size);
+		Batch& GetPendingBatch();
+		Batch CreateBatch();
+		void RetireBatch(Batch& batch);
+		void DestroyBatch(Batch& batch);
+
+		bool HasOwnershipTransfer() const { return m_TransferFamily != m_GraphicsFamily; }
+
+	private:
+		uint32_t m_GraphicsFamily = 0;
+		uint32_t m_TransferFamily = 0;
+
+		VkCommandPool m_TransferCommandPool = VK_NULL_HANDLE;
+		VkCommandPool m_GraphicsCommandPool = VK_NULL_HANDLE;
+
+		StagingBuffer m_Staging;
+		uint8_t* m_StagingData = nullptr;
+		VkDeviceSize m_StagingSize = 0;
+		VkDeviceSize m_StagingHead = 0;
+		VkDeviceSize m_StagingUsed = 0;
+		VkDeviceSize m_StagingAlignment = 16;
+
+		std::optional<Batch> m_PendingBatch;
+		std::deque<Batch> m_InFlightBatches; // Submission order, retired from the front
+		std::vector<Batch> m_FreeBatches;
+
+		uint64_t m_NextBatchID = 1;
+		std::atomic<uint64_t> m_CompletedBatchID = 0; // Polled from loading threads
+
+		std::mutex m_Mutex;
+	};
+
+}
\ No newline at end of file
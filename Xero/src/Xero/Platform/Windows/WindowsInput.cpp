@@ -8,19 +8,30 @@
 
 namespace Xero {
 
+	// Null for a headless window, every input query then reports nothing pressed
+	static GLFWwindow* GetNativeWindow()
+	{
+		return static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
+	}
+
 	bool Input::IsKeyPressed(KeyCode keycode)
 	{
-		auto& window = static_cast<WindowsWindow&>(Application::Get().GetWindow());
-		auto state = glfwGetKey(static_cast<GLFWwindow*>(window.GetNativeWindow()), static_cast<int32_t>(keycode));
+		GLFWwindow* window = GetNativeWindow();
+		if (!window)
+			return false;
+
+		auto state = glfwGetKey(window, static_cast<int32_t>(keycode));
 
 		return state == GLFW_PRESS || state == GLFW_REPEAT;
 	}
 
 	bool Input::IsMouseButtonPressed(int button)
 	{
-		auto& window = static_cast<WindowsWindow&>(Application::Get().GetWindow());
+		GLFWwindow* window = GetNativeWindow();
+		if (!window)
+			return false;
 
-		auto state = glfwGetMouseButton(static_cast<GLFWwindow*>(window.GetNativeWindow()), button);
+		auto state = glfwGetMouseButton(window, button);
 		return state == GLFW_PRESS;
 	}
 
@@ -38,10 +49,12 @@ namespace Xero {
 
 	std::pair<float, float> Input::GetMousePosition()
 	{
-		auto& window = static_cast<WindowsWindow&>(Application::Get().GetWindow());
-		double x, y;
+		GLFWwindow* window = GetNativeWindow();
+		if (!window)
+			return { 0.0f, 0.0f };
 
-		glfwGetCursorPos(static_cast<GLFWwindow*>(window.GetNativeWindow()), &x, &y);
+		double x, y;
+		glfwGetCursorPos(window, &x, &y);
 		return { (float)x, (float)y };
 	}
 
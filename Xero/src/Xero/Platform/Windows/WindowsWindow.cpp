@@ -9,6 +9,7 @@
 
 #include "Xero/Renderer/RendererContext.h"
 #include "Xero/Platform/Vulkan/VulkanContext.h"
+#include "Xero/Platform/Headless/HeadlessWindow.h"
 
 namespace Xero {
 
@@ -21,6 +22,9 @@ namespace Xero {
 
 	Scope<Window> Window::Create(const WindowProps& props)
 	{
+		if (props.Headless)
+			return CreateScope<HeadlessWindow>(props);
+
 		return CreateScope<WindowsWindow>(props);
 	}
 
@@ -161,6 +165,9 @@ namespace Xero {
 
 	void WindowsWindow::Shutdown()
 	{
+		// Before the surface's window and the context go
+		m_Swapchain.Cleanup();
+		m_RendererContext->Shutdown();
 		glfwDestroyWindow(m_Window);
 	}
 
@@ -172,6 +179,8 @@ namespace Xero {
 	void WindowsWindow::SwapBuffers()
 	{
 		m_Swapchain.Present();
+
+		m_RendererContext.As<VulkanContext>()->SavePipelineCacheIfNeeded();
 	}
 
 	void WindowsWindow::SetVSync(bool enabled)
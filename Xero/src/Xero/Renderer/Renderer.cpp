@@ -1,19 +1,54 @@
 #include "xopch.h"
 #include "Renderer.h"
 
-#include "Xero/Platform/Vulkan/VulkanSwapchain.h"
+#include "Xero/Platform/Vulkan/VulkanShader.h"
+#include "Xero/Platform/Vulkan/VulkanRenderer.h"
 
 namespace Xero {
 
+	static Ref<ShaderLibrary> s_ShaderLibrary;
+
+	void Renderer::Init()
+	{
+		s_ShaderLibrary = Ref<ShaderLibrary>::Create();
+
+		// One batch, so the files compile across the worker pool instead of one after another
+		const std::vector<std::string>& startupShaders = GetConfig().StartupShaders;
+		if (!startupShaders.empty())
+			s_ShaderLibrary->LoadBatch(startupShaders);
+	}
+
+	void Renderer::Shutdown()
+	{
+		// The shaders queue their frees with the renderer, so they have to go while the context is still alive
+		s_ShaderLibrary = nullptr;
+	}
+
 	RendererConfig& Renderer::GetConfig()
 	{
 		static RendererConfig config;
 		return config;
 	}
 
+	Ref<ShaderLibrary> Renderer::GetShaderLibrary()
+	{
+		return s_ShaderLibrary;
+	}
+
 	uint32_t Renderer::GetCurrentFrameIndex()
 	{
-		return Application::Get().GetWindow().GetSwapchain().GetCurrentBufferIndex();
+		return VulkanRenderer::GetCurrentFrameIndex();
+	}
+
+	void Renderer::BeginFrame()
+	{
+		VulkanRenderer::BeginFrame();
+	}
+
+	void Renderer::EndFrame()
+	{
+		VulkanShader::ProcessHotReload();
+		VulkanRenderer::EndFrame();
 	}
 
 }
\ No newline at end of file
@@ -1,20 +1,41 @@
 #pragma once
 
 #include "RendererContext.h"
+#include "Shader.h"
 
 namespace Xero {
 
 	struct RendererConfig
 	{
 		uint32_t FramesInFlight = 3;
+		// One global texture/buffer table indexed through push constants instead of per-draw descriptor sets.
+		// Needs descriptor indexing, ignored when the device does not support it
+		bool Bindless = false;
+		// Renders into offscreen images instead of a swapchain, no surface or presentation support is needed.
+		// Set by the headless window before the context is created
+		bool Headless = false;
+		// Uniform data one frame may write. The ring cannot grow, every descriptor set points into it
+		uint32_t UniformBufferRegionSize = 4 * 1024 * 1024;
+		// Loaded into the shader library by Renderer::Init, set them before the application is created
+		std::vector<std::string> StartupShaders;
 	};
 
 	class Renderer
 	{
 	public:
+		static void Init();
+		static void Shutdown();
+
 		static RendererConfig& GetConfig();
+		static Ref<ShaderLibrary> GetShaderLibrary();
 
+		// Frame in flight being recorded, not the swapchain image index
 		static uint32_t GetCurrentFrameIndex();
+
+		// Called before any rendering work of the frame is recorded
+		static void BeginFrame();
+		// Called once the frame has been presented, work deferred to a frame boundary runs here
+		static void EndFrame();
 	};
 
 }
\ No newline at end of file
@@ -13,6 +13,8 @@ namespace Xero {
 		virtual ~RendererContext() = default;
 
 		virtual void Init() = 0;
+		// Called by the window while it still holds the context, the API's globals look the context up through it
+		virtual void Shutdown() = 0;
 
 		static Ref<RendererContext> Create();
 	};
@@ -17,6 +17,17 @@ namespace Xero {
 		XO_CORE_ASSERT(false, "Unknown RendererAPI");
 	}
 
+	std::vector<Ref<Shader>> Shader::CreateBatch(const std::vector<std::string>& filepaths, bool forceCompile)
+	{
+		switch (RendererAPI::Current())
+		{
+			case RendererAPIType::Vulkan:		return VulkanShader::CreateBatch(filepaths, forceCompile);
+		}
+
+		XO_CORE_ASSERT(false, "Unknown RendererAPI");
+		return {};
+	}
+
 	ShaderLibrary::ShaderLibrary()
 	{
 
@@ -48,6 +59,16 @@ namespace Xero {
 		m_Shaders[name] = Shader::Create(path);
 	}
 
+	void ShaderLibrary::LoadBatch(const std::vector<std::string>& paths, bool forceCompile /*= false*/)
+	{
+		for (auto& shader : Shader::CreateBatch(paths, forceCompile))
+		{
+			auto& name = shader->GetName();
+			XO_CORE_ASSERT(m_Shaders.find(name) == m_Shaders.end());
+			m_Shaders[name] = shader;
+		}
+	}
+
 	const Ref<Shader>& ShaderLibrary::Get(const std::string& name) const
 	{
 		XO_CORE_ASSERT(m_Shaders.find(name) != m_Shaders.end());
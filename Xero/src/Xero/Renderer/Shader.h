@@ -65,6 +65,7 @@ namespace Xero {
 		virtual const std::string& GetName() const = 0;
 
 		static Ref<Shader> Create(const std::string& filepath, bool forceCompile = false);
+		static std::vector<Ref<Shader>> CreateBatch(const std::vector<std::string>& filepaths, bool forceCompile = false);
 
 		virtual const std::unordered_map<std::string, ShaderBuffer>& GetShaderBuffers() const = 0;
 		virtual const std::unordered_map<std::string, ShaderResourceDeclaration>& GetResources() const = 0;
@@ -88,6 +89,7 @@ namespace Xero {
 		void Add(const Ref<Shader>& shader);
 		void Load(const std::string& path, bool forceCompile = false);
 		void Load(const std::string& name, const std::string& path);
+		void LoadBatch(const std::vector<std::string>& paths, bool forceCompile = false);
 
 		const Ref<Shader>& Get(const std::string& name) const;
 	private:
@@ -0,0 +1,118 @@
+#include "xopch.h"
+#include "ShaderCache.h"
+
+namespace Xero {
+
+	static const char* s_ManifestHeader = "XeroShaderCache";
+	static constexpr uint32_t s_ManifestVersion = 1;
+
+	ShaderCache::ShaderCache(const std::filesystem::path& manifestPath)
+		: m_ManifestPath(manifestPath)
+	{
+		Load();
+	}
+
+	bool ShaderCache::HasChanged(const std::string& key, uint32_t hash)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		auto it = m_Hashes.find(key);
+		return it == m_Hashes.end() || it->second != hash;
+	}
+
+	void ShaderCache::Update(const std::string& key, uint32_t hash)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_Hashes[key] = hash;
+		m_Dirty = true;
+
+		if (m_BatchDepth == 0)
+			Save();
+	}
+
+	void ShaderCache::Invalidate(const std::string& key)
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		if (!m_Hashes.erase(key))
+			return;
+
+		m_Dirty = true;
+		if (m_BatchDepth == 0)
+			Save();
+	}
+
+	void ShaderCache::BeginBatch()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		m_BatchDepth++;
+	}
+
+	void ShaderCache::EndBatch()
+	{
+		std::scoped_lock<std::mutex> lock(m_Mutex);
+		XO_CORE_ASSERT(m_BatchDepth > 0);
+
+		if (--m_BatchDepth == 0 && m_Dirty)
+			Save();
+	}
+
+	void ShaderCache::Load()
+	{
+		std::ifstream in(m_ManifestPath);
+		if (!in)
+			return;
+
+		std::string header;
+		uint32_t version = 0;
+		in >> header >> version;
+		if (header != s_ManifestHeader || version != s_ManifestVersion)
+		{
+			// Unknown manifest, every entry will be treated as out of date
+			XO_CORE_WARN("ShaderCache: ignoring incompatible manifest {0}", m_ManifestPath.string());
+			return;
+		}
+
+		std::string key;
+		uint32_t hash;
+		while (in >> key >> std::hex >> hash >> std::dec)
+			m_Hashes[key] = hash;
+	}
+
+	void ShaderCache::Save()
+	{
+		// Write to a temporary file first so a crash never leaves a truncated manifest behind
+		std::filesystem::path tempPath = m_ManifestPath;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream out(tempPath, std::ios::out | std::ios::trunc);
+			if (!out)
+			{
+				XO_CORE_ERROR("ShaderCache: could not write manifest {0}", m_ManifestPath.string());
+				return;
+			}
+
+			out << s_ManifestHeader << " " << s_ManifestVersion << "\n";
+			for (const auto& [key, hash] : m_Hashes)
+				out << key << " " << std::hex << hash << std::dec << "\n";
+
+			out.flush();
+			if (!out)
+			{
+				XO_CORE_ERROR("ShaderCache: could not write manifest {0}", m_ManifestPath.string());
+				return;
+			}
+		}
+
+		// Stays dirty on failure, so the next change or batch tries again
+		std::error_code error;
+		std::filesystem::rename(tempPath, m_ManifestPath, error);
+		if (error)
+		{
+			XO_CORE_ERROR("ShaderCache: could not replace manifest {0} ({1})", m_ManifestPath.string(), error.message());
+			return;
+		}
+
+		m_Dirty = false;
+	}
+
+}
\ No newline at end of file
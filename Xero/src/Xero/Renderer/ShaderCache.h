@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+
+namespace Xero {
+
+	// Manifest of content hashes for cached shader binaries, an entry is only
+	// valid while the hash of its inputs (source, options, target) matches
+	class ShaderCache
+	{
+	public:
+		ShaderCache(const std::filesystem::path& manifestPath);
+
+		bool HasChanged(const std::string& key, uint32_t hash);
+		void Update(const std::string& key, uint32_t hash);
+		void Invalidate(const std::string& key);
+
+		// Manifest writes are deferred until the outermost EndBatch, loading many shaders then writes it once
+		void BeginBatch();
+		void EndBatch();
+
+	private:
+		void Load();
+		void Save();
+
+	private:
+		std::filesystem::path m_ManifestPath;
+		std::unordered_map<std::string, uint32_t> m_Hashes;
+		uint32_t m_BatchDepth = 0;
+		bool m_Dirty = false;
+		std::mutex m_Mutex;
+	};
+
+}
\ No newline at end of file
@@ -16,6 +16,7 @@ IncludeDir["GLFW"] = "Xero/vendor/GLFW/include"
 IncludeDir["ImGui"] = "Xero/vendor/ImGui"
 IncludeDir["glm"] = "Xero/vendor/glm"
 IncludeDir["Vulkan"] = "Xero/vendor/Vulkan/Include"
+IncludeDir["stb"] = "Xero/vendor/GLFW/deps"
 
 LibraryDir = {}
 LibraryDir["Vulkan"] = "vendor/Vulkan/Lib/vulkan-1.lib"
@@ -52,7 +53,8 @@ project "Xero"
 		"%{IncludeDir.GLFW}",
 		"%{IncludeDir.ImGui}",
 		"%{IncludeDir.Vulkan}",
-		"%{IncludeDir.glm}"
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.stb}"
 	}
 
 	files 